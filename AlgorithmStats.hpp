@@ -0,0 +1,96 @@
+#ifndef AlgorithmStats_hpp
+#define AlgorithmStats_hpp
+
+#include <ostream>
+#include <chrono>
+#include <cstddef>
+
+/// Counters telling how much work an algorithm did, to find out why a search is slow
+/// without a profiler. The counters are collected only when the code is compiled with
+/// GRAPH_STATS defined (cmake -DGRAPH_STATS=ON). Otherwise the counting code is
+/// compiled out and the counters stay zero, so there is no cost at all.
+struct AlgorithmStats {
+   unsigned long verticesSettled = 0;  // Vertices whose path became final (Dijkstra) or added to the tree (Prim).
+   unsigned long edgesRelaxed = 0;     // Edges examined from the settled vertices.
+   unsigned long edgesImproved = 0;    // Examined edges that gave a better path to their destination.
+   unsigned long heapPushes = 0;       // Pushes to the priority queue.
+   unsigned long heapPops = 0;         // Pops from the priority queue.
+   unsigned long stalePops = 0;        // Popped elements ignored since the vertex was already handled.
+   unsigned long lookups = 0;          // Map, set and binary search lookups of vertices.
+   unsigned long allocations = 0;      // Heap allocations of the growing priority queues and of the set and map nodes added.
+   unsigned long cacheHits = 0;        // Results taken from the path cache without searching.
+   double wallSeconds = 0.0;           // Time the algorithm took.
+};
+
+#ifdef GRAPH_STATS
+/// Adds amount to the counter of stats, if stats is given.
+#define GRAPH_STATS_ADD(stats, counter, amount) do { if (stats) { (stats)->counter += (amount); } } while (false)
+#else
+#define GRAPH_STATS_ADD(stats, counter, amount) do { } while (false)
+#endif
+
+/// Measures the time from creation to destruction into the wallSeconds of the stats.
+/// Empty when GRAPH_STATS is not defined.
+class StatsTimer {
+public:
+#ifdef GRAPH_STATS
+   StatsTimer(AlgorithmStats * stats)
+   : stats(stats), started(std::chrono::steady_clock::now()) {
+   }
+   ~StatsTimer() {
+      if (stats) {
+         std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+         stats->wallSeconds += elapsed.count();
+      }
+   }
+private:
+   AlgorithmStats * stats;
+   std::chrono::steady_clock::time_point started;
+#else
+   StatsTimer(AlgorithmStats *) {
+   }
+#endif
+};
+
+/// Counts the allocations of a growing vector (or a priority queue using one). Vector doubles
+/// its capacity when it gets full, so each time the size goes past the capacity it has allocated.
+/// Does nothing when GRAPH_STATS is not defined.
+class GrowthCounter {
+public:
+#ifdef GRAPH_STATS
+   GrowthCounter(AlgorithmStats * stats)
+   : stats(stats), capacity(0) {
+   }
+   /// Tells the current size of the container, after adding elements to it.
+   void sizeIs(std::size_t size) {
+      while (stats && size > capacity) {
+         stats->allocations++;
+         capacity = capacity == 0 ? 1 : 2 * capacity;
+      }
+   }
+private:
+   AlgorithmStats * stats;
+   std::size_t capacity;
+#else
+   GrowthCounter(AlgorithmStats *) {
+   }
+   void sizeIs(std::size_t) {
+   }
+#endif
+};
+
+inline std::ostream & operator << (std::ostream & stream, const AlgorithmStats & stats) {
+   stream << "settled: " << stats.verticesSettled
+          << ", relaxed: " << stats.edgesRelaxed
+          << ", improved: " << stats.edgesImproved
+          << ", pushes: " << stats.heapPushes
+          << ", pops: " << stats.heapPops
+          << ", stale pops: " << stats.stalePops
+          << ", lookups: " << stats.lookups
+          << ", allocations: " << stats.allocations
+          << ", cache hits: " << stats.cacheHits
+          << ", time: " << stats.wallSeconds * 1000.0 << " ms";
+   return stream;
+}
+
+#endif /* AlgorithmStats_hpp */
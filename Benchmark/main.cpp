@@ -0,0 +1,654 @@
+//
+//  main.cpp
+//  Benchmark
+//
+//  Runs the algorithms of Graph, Dijkstra and Prim on synthetic graphs of
+//  different sizes and reports the time, throughput and memory used as JSON.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <cstddef>
+#include <cmath>
+#include <random>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "Graph.hpp"
+#include "Dijkstra.hpp"
+#include "QueryExecutor.hpp"
+#include "Prim.hpp"
+#include "KShortestPaths.hpp"
+#include "ParetoRouting.hpp"
+#include "Betweenness.hpp"
+#include "CriticalPath.hpp"
+#include "Reachability.hpp"
+#include "Landmarks.hpp"
+#include "GraphGenerator.hpp"
+#include "GraphExport.hpp"
+#include "CompactGraph.hpp"
+#include "CompressedGraph.hpp"
+#include "MappedGraph.hpp"
+
+// MARK: - Memory tracking
+
+/*
+ All allocations of the benchmark go through these replaced operators, so the
+ bytes allocated at a time and the peak of those can be tracked per benchmark.
+ Each block has a header in front of it holding the size of the block.
+ */
+namespace {
+   std::atomic<long long> allocatedBytes(0);
+   std::atomic<long long> peakBytes(0);
+   const std::size_t headerSize = alignof(std::max_align_t);
+
+   void resetPeak() {
+      peakBytes = allocatedBytes.load();
+   }
+
+   // Frees a block made by operator new. Called by all the forms of operator delete and not
+   // inlined into them, so GCC does not see the delete expressions free the pointer given by
+   // malloc, which it would take for a mismatched deallocation (-Wmismatched-new-delete).
+   [[gnu::noinline]] void releaseBlock(void * pointer) noexcept {
+      if (pointer != nullptr) {
+         char * block = static_cast<char *>(pointer) - headerSize;
+         allocatedBytes -= *reinterpret_cast<std::size_t *>(block);
+         std::free(block);
+      }
+   }
+}
+
+void * operator new (std::size_t size) {
+   char * block = static_cast<char *>(std::malloc(size + headerSize));
+   if (block == nullptr) {
+      throw std::bad_alloc();
+   }
+   *reinterpret_cast<std::size_t *>(block) = size;
+   long long now = allocatedBytes += size;
+   long long peak = peakBytes.load();
+   while (now > peak && !peakBytes.compare_exchange_weak(peak, now)) {
+      // peak was updated by compare_exchange_weak, try again.
+   }
+   return block + headerSize;
+}
+
+void operator delete (void * pointer) noexcept {
+   releaseBlock(pointer);
+}
+
+// The sized and array forms must be replaced too, or the blocks would be freed by the
+// library versions without the header being taken into account.
+void operator delete (void * pointer, std::size_t) noexcept {
+   releaseBlock(pointer);
+}
+
+void * operator new[] (std::size_t size) {
+   return operator new(size);
+}
+
+void operator delete[] (void * pointer) noexcept {
+   releaseBlock(pointer);
+}
+
+void operator delete[] (void * pointer, std::size_t) noexcept {
+   releaseBlock(pointer);
+}
+
+// MARK: - Inputs and benchmarks
+
+// A generated graph the benchmarks are run on.
+struct Input {
+   std::string family;
+   int vertexCount;
+   EdgeType type;
+   std::vector<GeneratedEdge> edges;
+   Graph<int> graph;
+   std::map<VertexOrder, std::shared_ptr<CompactGraph<int>>> compact;   // Made when first needed.
+   std::shared_ptr<CompressedGraph<int>> compressed;                    // Made when first needed.
+#if defined(__unix__) || defined(__APPLE__)
+   std::shared_ptr<MappedGraph> mapped;                                 // Made when first needed.
+#endif
+};
+
+// Stream buffer counting the bytes written to it and dropping them, so the exporters
+// can be measured without the speed of the disk.
+class CountingBuffer : public std::streambuf {
+public:
+   long long bytes = 0;
+protected:
+   int_type overflow(int_type character) override {
+      bytes++;
+      return traits_type::not_eof(character);
+   }
+   std::streamsize xsputn(const char *, std::streamsize count) override {
+      bytes += count;
+      return count;
+   }
+};
+
+// A benchmark runs one algorithm on an input and returns the number of items it handled,
+// used to calculate the throughput (items per second). Algorithms supporting AlgorithmStats
+// count their work to the stats given, when compiled with GRAPH_STATS.
+struct Benchmark {
+   std::string name;
+   std::vector<std::string> families;   // Input families the benchmark is run on.
+   int maxVertices;                     // Larger inputs are skipped, for algorithms slower than O(E log V).
+   std::function<long(Input &, AlgorithmStats &)> run;
+};
+
+// Result of running a benchmark on an input.
+struct Result {
+   std::string name;
+   std::string family;
+   int vertices;
+   long edges;
+   int repeats;
+   double bestSeconds;
+   double meanSeconds;
+   long items;
+   long long peakBytes;
+   long processPeakRssKb;   // Peak of the whole process so far, it never goes down between benchmarks.
+   AlgorithmStats stats;   // Counters of the last round.
+};
+
+std::vector<Benchmark> createBenchmarks();
+const CompactGraph<int> & compactOf(Input & input, VertexOrder order);
+const CompressedGraph<int> & compressedOf(Input & input);
+#if defined(__unix__) || defined(__APPLE__)
+const MappedGraph & mappedOf(Input & input);
+#endif
+long reachabilityQueries(const Reachability<int> & reachability, int vertexCount);
+void createInput(Input & input, const std::string & family, int size, unsigned long seed);
+long peakRss();
+void writeJson(std::ostream & stream, const std::vector<Result> & results);
+std::vector<int> parseSizes(const std::string & text);
+
+int main(int argc, const char * argv[]) {
+   std::vector<int> sizes = {1000, 10000, 100000};
+   int repeats = 3;
+   unsigned long seed = 1;
+   std::string filter;
+   std::string outputPath;
+
+   for (int arg = 1; arg < argc; arg++) {
+      std::string option(argv[arg]);
+      if (option == "--sizes" && arg + 1 < argc) {
+         sizes = parseSizes(argv[++arg]);
+      } else if (option == "--repeat" && arg + 1 < argc) {
+         repeats = std::max(1, std::atoi(argv[++arg]));
+      } else if (option == "--seed" && arg + 1 < argc) {
+         seed = std::strtoul(argv[++arg], nullptr, 10);
+      } else if (option == "--filter" && arg + 1 < argc) {
+         filter = argv[++arg];
+      } else if (option == "--output" && arg + 1 < argc) {
+         outputPath = argv[++arg];
+      } else {
+         std::cout << "Usage: benchmark [--sizes 1000,10000,...] [--repeat n] [--seed n] [--filter name] [--output file.json]" << std::endl;
+         return EXIT_FAILURE;
+      }
+   }
+
+   const std::vector<Benchmark> benchmarks = createBenchmarks();
+   // Exponential algorithms are only run on this small input, always of the same size.
+   std::vector<std::pair<std::string, int>> inputs = { {"dag-small", 100} };
+   for (int size : sizes) {
+      for (const std::string family : {"grid", "random", "powerlaw", "dag"}) {
+         inputs.push_back( {family, size} );
+      }
+   }
+
+   std::vector<Result> results;
+   for (const auto & [family, size] : inputs) {
+      Input input;
+      createInput(input, family, size, seed);
+      for (const auto & benchmark : benchmarks) {
+         if (std::find(benchmark.families.begin(), benchmark.families.end(), family) == benchmark.families.end() ||
+             input.vertexCount > benchmark.maxVertices ||
+             benchmark.name.find(filter) == std::string::npos) {
+            continue;
+         }
+         Result result{benchmark.name, family, input.vertexCount, static_cast<long>(input.edges.size()), repeats, 0.0, 0.0, 0, 0, 0, AlgorithmStats()};
+         double total = 0.0;
+         for (int round = 0; round < repeats; round++) {
+            long long allocatedBefore = allocatedBytes.load();
+            resetPeak();
+            auto started = std::chrono::steady_clock::now();
+            result.stats = AlgorithmStats();
+            result.items = benchmark.run(input, result.stats);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+            result.peakBytes = std::max(result.peakBytes, peakBytes.load() - allocatedBefore);
+            total += elapsed.count();
+            if (round == 0 || elapsed.count() < result.bestSeconds) {
+               result.bestSeconds = elapsed.count();
+            }
+         }
+         result.meanSeconds = total / repeats;
+         result.processPeakRssKb = peakRss();
+         std::cerr << benchmark.name << " " << family << " V=" << input.vertexCount << " E=" << input.edges.size()
+                   << " " << result.bestSeconds * 1000.0 << " ms" << std::endl;
+         results.push_back(result);
+      }
+   }
+
+   if (outputPath.empty()) {
+      writeJson(std::cout, results);
+   } else {
+      std::ofstream file(outputPath);
+      writeJson(file, results);
+   }
+   return EXIT_SUCCESS;
+}
+
+/*
+ Creates the graph of the family with approximately size vertices.
+ Undirected families have on average four edges per vertex.
+ */
+void createInput(Input & input, const std::string & family, int size, unsigned long seed) {
+   GraphGenerator generator(seed);
+   int side = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(size))));
+   input.family = family;
+   if (family == "grid") {
+      input.vertexCount = side * side;
+      input.type = EdgeType::EUndirected;
+      input.edges = generator.grid(side, side);
+   } else if (family == "random") {
+      input.vertexCount = size;
+      input.type = EdgeType::EUndirected;
+      input.edges = generator.randomSparse(size, 2L * size);
+   } else if (family == "powerlaw") {
+      int scale = std::max(1, static_cast<int>(std::ceil(std::log2(static_cast<double>(size)))));
+      input.vertexCount = 1 << scale;
+      input.type = EdgeType::EUndirected;
+      input.edges = generator.powerLaw(scale, 2L * input.vertexCount);
+   } else {
+      // dag and dag-small: directed grid, edges going right and down.
+      input.vertexCount = side * side;
+      input.type = EdgeType::EDirected;
+      input.edges = generator.grid(side, side);
+   }
+   GraphGenerator::fill(input.graph, input.vertexCount, input.edges, input.type);
+}
+
+const CompactGraph<int> & compactOf(Input & input, VertexOrder order) {
+   auto & compact = input.compact[order];
+   if (!compact) {
+      compact = std::make_shared<CompactGraph<int>>(input.graph, order);
+   }
+   return *compact;
+}
+
+// The generated weights are whole numbers, so they are stored exactly with step 1.
+const CompressedGraph<int> & compressedOf(Input & input) {
+   if (!input.compressed) {
+      input.compressed = std::make_shared<CompressedGraph<int>>(compactOf(input, ECuthillMcKeeOrder), 1.0);
+   }
+   return *input.compressed;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// The file is removed once mapped; the mapping keeps it until unmapped.
+const MappedGraph & mappedOf(Input & input) {
+   if (!input.mapped) {
+      std::string path = "benchmark-" + input.family + "-" + std::to_string(input.vertexCount) + ".map";
+      input.mapped = std::make_shared<MappedGraph>();
+      if (!MappedGraph::write(compactOf(input, ECuthillMcKeeOrder), path) || !input.mapped->open(path)) {
+         std::cerr << "Could not write " << path << std::endl;
+      }
+      std::remove(path.c_str());
+   }
+   return *input.mapped;
+}
+#endif
+
+// Asks a million questions between random vertices, returning the number of yes answers.
+long reachabilityQueries(const Reachability<int> & reachability, int vertexCount) {
+   std::mt19937_64 random(1);
+   std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+   long reached = 0;
+   for (int query = 0; query < 1000000; query++) {
+      reached += reachability.reaches(vertex(random), vertex(random));
+   }
+   return reached;
+}
+
+std::vector<Benchmark> createBenchmarks() {
+   const std::vector<std::string> all = {"grid", "random", "powerlaw", "dag"};
+   const std::vector<std::string> undirected = {"grid", "random", "powerlaw"};
+   const int unlimited = std::numeric_limits<int>::max();
+   std::vector<Benchmark> benchmarks;
+
+   // MARK: Graph
+   benchmarks.push_back({"Graph::createVertex+add", all, unlimited, [](Input & input, AlgorithmStats &) {
+      Graph<int> graph;
+      for (int vertex = 1; vertex <= input.vertexCount; vertex++) {
+         graph.createVertex(vertex);
+      }
+      for (const auto & edge : input.edges) {
+         graph.add(input.type, Vertex<int>(edge.source), Vertex<int>(edge.destination), edge.weight);
+      }
+      return static_cast<long>(input.edges.size());
+   }});
+   benchmarks.push_back({"Graph::buildFrom", all, unlimited, [](Input & input, AlgorithmStats &) {
+      Graph<int> graph;
+      GraphGenerator::fill(graph, input.vertexCount, input.edges, input.type, static_cast<int>(std::thread::hardware_concurrency()));
+      return static_cast<long>(input.edges.size());
+   }});
+   benchmarks.push_back({"Graph::breadthFirstSearchFrom", all, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(input.graph.breadthFirstSearchFrom(Vertex<int>(1)).size());
+   }});
+   benchmarks.push_back({"Graph::depthFirstSearchFrom", all, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(input.graph.depthFirstSearchFrom(Vertex<int>(1)).size());
+   }});
+   benchmarks.push_back({"Graph::allVertices", all, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(input.graph.allVertices().size());
+   }});
+   benchmarks.push_back({"Graph::weight", all, unlimited, [](Input & input, AlgorithmStats &) {
+      double sum = 0.0;
+      for (const auto & edge : input.edges) {
+         sum += input.graph.weight(Vertex<int>(edge.source), Vertex<int>(edge.destination));
+      }
+      return sum > 0.0 ? static_cast<long>(input.edges.size()) : 0L;
+   }});
+   benchmarks.push_back({"Graph::hasDestination", all, unlimited, [](Input & input, AlgorithmStats &) {
+      long found = 0;
+      for (const auto & edge : input.edges) {
+         found += input.graph.hasDestination(Vertex<int>(edge.source), Vertex<int>(edge.destination)) ? 1 : 0;
+      }
+      return found;
+   }});
+   benchmarks.push_back({"Graph::isDisconnected", all, 10000, [](Input & input, AlgorithmStats &) {
+      input.graph.isDisconnected();
+      return static_cast<long>(input.vertexCount);
+   }});
+   benchmarks.push_back({"Graph::topologicalSort", {"dag"}, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(input.graph.topologicalSort().size());
+   }});
+   benchmarks.push_back({"Graph::sources", all, unlimited, [](Input & input, AlgorithmStats &) {
+      // Touching makes the incoming edges to be found again, as after changing the graph.
+      input.graph.touch();
+      input.graph.sources();
+      return static_cast<long>(input.edges.size());
+   }});
+   benchmarks.push_back({"Graph::hasCycle", {"dag-small"}, unlimited, [](Input & input, AlgorithmStats &) {
+      input.graph.hasCycle(Vertex<int>(1));
+      return static_cast<long>(input.vertexCount);
+   }});
+   benchmarks.push_back({"Graph::numberOfPathsFrom", {"dag-small"}, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(input.graph.numberOfPathsFrom(Vertex<int>(1), Vertex<int>(input.vertexCount)));
+   }});
+
+   // MARK: Dijkstra
+   benchmarks.push_back({"Dijkstra::shortestPathsFrom", all, unlimited, [](Input & input, AlgorithmStats &) {
+      input.graph.pathCache.setCapacity(0);
+      return static_cast<long>(Dijkstra<int>(input.graph).shortestPathsFrom(Vertex<int>(1)).size());
+   }});
+   benchmarks.push_back({"Dijkstra::lowestPathsFrom", all, unlimited, [](Input & input, AlgorithmStats &) {
+      input.graph.pathCache.setCapacity(0);
+      return static_cast<long>(Dijkstra<int>(input.graph).lowestPathsFrom(Vertex<int>(1)).size());
+   }});
+   benchmarks.push_back({"Dijkstra::shortestPathTreeFrom", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      input.graph.pathCache.setCapacity(0);
+      return static_cast<long>(Dijkstra<int>(input.graph).shortestPathTreeFrom(Vertex<int>(1), stats)->reachedCount());
+   }});
+   benchmarks.push_back({"Dijkstra::lowestPathTreeFrom", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      input.graph.pathCache.setCapacity(0);
+      return static_cast<long>(Dijkstra<int>(input.graph).lowestPathTreeFrom(Vertex<int>(1), stats)->reachedCount());
+   }});
+   benchmarks.push_back({"Dijkstra::shortestPathTreeFrom(cached)", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      // 100 queries from the same start vertex, all but the first answered by the path cache.
+      input.graph.pathCache.setCapacity(16);
+      input.graph.pathCache.clear();
+      Dijkstra<int> dijkstra(input.graph);
+      for (int query = 0; query < 100; query++) {
+         dijkstra.shortestPathTreeFrom(Vertex<int>(1), stats);
+      }
+      return 100L;
+   }});
+   benchmarks.push_back({"Dijkstra::shortestPathTo", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      // Routes from the start to every vertex using a tree searched once, with a reused buffer.
+      input.graph.pathCache.setCapacity(0);
+      auto tree = Dijkstra<int>(input.graph).shortestPathTreeFrom(Vertex<int>(1), stats);
+      std::vector<int> route;
+      long hops = 0;
+      for (int index = 0; index < tree->size(); index++) {
+         hops += tree->routeTo(index, route);
+      }
+      return hops;
+   }});
+   benchmarks.push_back({"Dijkstra::shortestPathTreeFrom(CancellationToken)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      // Same as shortestPathTreeFrom, checking a token with a deadline that does not pass.
+      input.graph.pathCache.setCapacity(0);
+      CancellationToken token(CancellationToken::Clock::now() + std::chrono::hours(1));
+      return static_cast<long>(Dijkstra<int>(input.graph).shortestPathTreeFrom(Vertex<int>(1), token)->reachedCount());
+   }});
+
+   // MARK: QueryExecutor
+   benchmarks.push_back({"QueryExecutor::shortestPaths(8 queries)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      input.graph.pathCache.setCapacity(0);
+      // Does not own the graph, the input outlives the executor.
+      QueryExecutor<int>::GraphPointer graph(std::shared_ptr<void>(), &input.graph);
+      QueryExecutor<int> executor(static_cast<int>(std::thread::hardware_concurrency()));
+      std::vector<QueryExecutor<int>::Query<QueryExecutor<int>::Paths>> queries;
+      for (int start = 1; start <= 8; start++) {
+         queries.push_back(executor.shortestPaths(graph, Vertex<int>(start), CancellationToken::Clock::now() + std::chrono::hours(1)));
+      }
+      long reached = 0;
+      for (auto & query : queries) {
+         reached += query.result.get()->reachedCount();
+      }
+      return reached;
+   }});
+
+   // MARK: CompactGraph
+   benchmarks.push_back({"CompactGraph(ECuthillMcKeeOrder)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      CompactGraph<int> compact(input.graph, ECuthillMcKeeOrder);
+      return compact.edgeCount();
+   }});
+   for (VertexOrder order : {EGraphOrder, ECuthillMcKeeOrder}) {
+      std::string orderName = order == EGraphOrder ? "(EGraphOrder)" : "(ECuthillMcKeeOrder)";
+      // The compact graph is made in the first round, so it is in the mean time but not in the best.
+      benchmarks.push_back({"CompactSearch::breadthFirstSearchFrom" + orderName, all, unlimited, [order](Input & input, AlgorithmStats &) {
+         const CompactGraph<int> & compact = compactOf(input, order);
+         return static_cast<long>(CompactSearch::breadthFirstSearchFrom(compact, compact.numberOf(Vertex<int>(1))).size());
+      }});
+      benchmarks.push_back({"CompactSearch::shortestPathTreeFrom" + orderName, all, unlimited, [order](Input & input, AlgorithmStats & stats) {
+         return static_cast<long>(CompactSearch::shortestPathTreeFrom(compactOf(input, order), Vertex<int>(1), stats)->reachedCount());
+      }});
+   }
+
+   // MARK: CompressedGraph
+   benchmarks.push_back({"CompressedGraph(ECuthillMcKeeOrder)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      CompressedGraph<int> compressed(compactOf(input, ECuthillMcKeeOrder), 1.0);
+      return compressed.edgeCount();
+   }});
+   benchmarks.push_back({"CompactSearch::breadthFirstSearchFrom(CompressedGraph)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      const CompressedGraph<int> & compressed = compressedOf(input);
+      return static_cast<long>(CompactSearch::breadthFirstSearchFrom(compressed, compressed.numberOf(Vertex<int>(1))).size());
+   }});
+   benchmarks.push_back({"CompactSearch::shortestPathTreeFrom(CompressedGraph)", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      return static_cast<long>(CompactSearch::shortestPathTreeFrom(compressedOf(input), Vertex<int>(1), stats)->reachedCount());
+   }});
+
+#if defined(__unix__) || defined(__APPLE__)
+   // MARK: MappedGraph
+   benchmarks.push_back({"MappedSearch::breadthFirstLevels", all, unlimited, [](Input & input, AlgorithmStats &) {
+      long reached = 0;
+      for (int level : MappedSearch::breadthFirstLevels(mappedOf(input), compactOf(input, ECuthillMcKeeOrder).numberOf(Vertex<int>(1)))) {
+         reached += level >= 0;
+      }
+      return reached;
+   }});
+   benchmarks.push_back({"MappedSearch::connectedComponents", all, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(MappedSearch::connectedComponents(mappedOf(input)).size());
+   }});
+   benchmarks.push_back({"MappedSearch::shortestPathsFrom", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      MappedPaths paths = MappedSearch::shortestPathsFrom(mappedOf(input), compactOf(input, ECuthillMcKeeOrder).numberOf(Vertex<int>(1)), stats);
+      return static_cast<long>(std::count_if(paths.distances.begin(), paths.distances.end(), [](double distance) {
+         return distance < std::numeric_limits<double>::infinity();
+      }));
+   }});
+#endif
+
+   // MARK: KShortestPaths
+   benchmarks.push_back({"KShortestPaths::kShortestPaths(k=10)", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      KShortestPaths<int> paths(input.graph);
+      return static_cast<long>(paths.kShortestPaths(Vertex<int>(1), Vertex<int>(input.vertexCount), 10, stats).size());
+   }});
+
+   // MARK: ParetoRouting
+   benchmarks.push_back({"ParetoRouting::routesBetween", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      ParetoRouting<int> routing(input.graph);
+      return static_cast<long>(routing.routesBetween(Vertex<int>(1), Vertex<int>(input.vertexCount), stats).size());
+   }});
+
+   // MARK: Betweenness
+   benchmarks.push_back({"Betweenness::exact", all, 1000, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(Betweenness<int>(input.graph, input.type).exact().size());
+   }});
+   benchmarks.push_back({"Betweenness::exact(unweighted)", all, 1000, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(Betweenness<int>(input.graph, input.type).exact(EUnweightedPaths).size());
+   }});
+   benchmarks.push_back({"Betweenness::sampled(64 pivots)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      return static_cast<long>(Betweenness<int>(input.graph, input.type).sampled(64, 1).size());
+   }});
+
+   // MARK: CriticalPath
+   benchmarks.push_back({"CriticalPath::analyze", {"dag"}, unlimited, [](Input & input, AlgorithmStats & stats) {
+      return static_cast<long>(CriticalPath<int>(input.graph).analyze(stats).vertices.size());
+   }});
+
+   // MARK: Reachability
+   benchmarks.push_back({"Reachability::reaches(build + 1M queries)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      Reachability<int> reachability(input.graph);
+      return reachabilityQueries(reachability, input.vertexCount);
+   }});
+   benchmarks.push_back({"Reachability::reaches(intervals, build + 1M queries)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      Reachability<int> reachability(input.graph, 0);
+      return reachabilityQueries(reachability, input.vertexCount);
+   }});
+
+   // MARK: Landmarks
+   benchmarks.push_back({"Landmarks::distance(select 8 + 100 queries)", all, unlimited, [](Input & input, AlgorithmStats & stats) {
+      Landmarks<int> landmarks(input.graph, input.type);
+      landmarks.select(8);
+      std::mt19937_64 random(1);
+      std::uniform_int_distribution<int> vertex(1, input.vertexCount);
+      long reached = 0;
+      for (int query = 0; query < 100; query++) {
+         reached += landmarks.distance(Vertex<int>(vertex(random)), Vertex<int>(vertex(random)), stats) < std::numeric_limits<double>::infinity();
+      }
+      return reached;
+   }});
+   benchmarks.push_back({"Landmarks::writeTables + readTables(8 landmarks)", all, unlimited, [](Input & input, AlgorithmStats &) {
+      Landmarks<int> landmarks(input.graph, input.type);
+      landmarks.select(8, EFarthestSelection);
+      std::stringstream tables;
+      if (!landmarks.writeTables(tables) || !landmarks.readTables(tables)) {
+         std::cerr << "Could not write and read the landmark tables" << std::endl;
+      }
+      return static_cast<long>(tables.str().size());
+   }});
+
+   // MARK: Prim
+   benchmarks.push_back({"Prim::produceMinimumSpanningTreeFor", undirected, unlimited, [](Input & input, AlgorithmStats & stats) {
+      Prim<int>().produceMinimumSpanningTreeFor(input.graph, stats);
+      return static_cast<long>(input.edges.size());
+   }});
+
+   // MARK: GraphExport
+   benchmarks.push_back({"GraphExport::writeEdgeList", all, unlimited, [](Input & input, AlgorithmStats &) {
+      CountingBuffer counter;
+      std::ostream stream(&counter);
+      GraphExport::writeEdgeList(stream, input.graph, input.type);
+      return static_cast<long>(input.edges.size());
+   }});
+   benchmarks.push_back({"GraphExport::writeDot", all, unlimited, [](Input & input, AlgorithmStats &) {
+      CountingBuffer counter;
+      std::ostream stream(&counter);
+      GraphExport::writeDot(stream, input.graph, input.type);
+      return static_cast<long>(input.edges.size());
+   }});
+   benchmarks.push_back({"GraphExport::writeCsv(Prim)", undirected, unlimited, [](Input & input, AlgorithmStats & stats) {
+      auto [cost, tree] = Prim<int>().produceMinimumSpanningTreeFor(input.graph, stats);
+      CountingBuffer counter;
+      std::ostream stream(&counter);
+      GraphExport::writeCsv(stream, tree, EUndirected);
+      return static_cast<long>(input.edges.size());
+   }});
+   return benchmarks;
+}
+
+/*
+ Peak resident set size of the process in kilobytes, zero if not available.
+ */
+long peakRss() {
+#if defined(__unix__) || defined(__APPLE__)
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+      return usage.ru_maxrss / 1024;   // bytes on macOS
+#else
+      return usage.ru_maxrss;          // kilobytes on Linux
+#endif
+   }
+#endif
+   return 0;
+}
+
+void writeJson(std::ostream & stream, const std::vector<Result> & results) {
+   stream << "{\n  \"results\": [\n";
+   for (std::size_t index = 0; index < results.size(); index++) {
+      const Result & result = results[index];
+      stream << "    {\"algorithm\": \"" << result.name << "\""
+             << ", \"input\": \"" << result.family << "\""
+             << ", \"vertices\": " << result.vertices
+             << ", \"edges\": " << result.edges
+             << ", \"repeats\": " << result.repeats
+             << ", \"best_seconds\": " << result.bestSeconds
+             << ", \"mean_seconds\": " << result.meanSeconds
+             << ", \"items\": " << result.items
+             << ", \"items_per_second\": " << (result.bestSeconds > 0.0 ? result.items / result.bestSeconds : 0.0)
+             << ", \"peak_bytes\": " << result.peakBytes
+             << ", \"process_peak_rss_kb\": " << result.processPeakRssKb;
+#ifdef GRAPH_STATS
+      stream << ", \"stats\": {\"vertices_settled\": " << result.stats.verticesSettled
+             << ", \"edges_relaxed\": " << result.stats.edgesRelaxed
+             << ", \"edges_improved\": " << result.stats.edgesImproved
+             << ", \"heap_pushes\": " << result.stats.heapPushes
+             << ", \"heap_pops\": " << result.stats.heapPops
+             << ", \"stale_pops\": " << result.stats.stalePops
+             << ", \"lookups\": " << result.stats.lookups
+             << ", \"allocations\": " << result.stats.allocations
+             << ", \"cache_hits\": " << result.stats.cacheHits
+             << ", \"wall_seconds\": " << result.stats.wallSeconds << "}";
+#endif
+      stream << "}" << (index + 1 < results.size() ? "," : "") << "\n";
+   }
+   stream << "  ]\n}\n";
+}
+
+std::vector<int> parseSizes(const std::string & text) {
+   std::vector<int> sizes;
+   std::istringstream stream(text);
+   std::string size;
+   while (std::getline(stream, size, ',')) {
+      if (std::atoi(size.c_str()) > 0) {
+         sizes.push_back(std::atoi(size.c_str()));
+      }
+   }
+   return sizes;
+}
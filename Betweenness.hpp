@@ -0,0 +1,268 @@
+#ifndef Betweenness_hpp
+#define Betweenness_hpp
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+#include "Graph.hpp"
+#include "Trace.hpp"
+
+/// How the length of a path is measured when computing betweenness.
+enum BetweennessPaths {
+   EWeightedPaths,      // Sum of the edge weights, searched with Dijkstra.
+   EUnweightedPaths     // Number of edges, searched breadth first.
+};
+
+/**
+ Betweenness centrality of the vertices: how many of the shortest paths between other
+ vertices go through each vertex. Vertices with a high betweenness are the transit points,
+ like the junction stations of a rail network, whose loss makes many routes longer.
+ When there are several shortest paths between two vertices, each gets an equal share.
+
+ Computed with Brandes' algorithm: a search from each source vertex counts the shortest
+ paths to each vertex, and then the dependencies of the source on the vertices are added
+ up going back from the farthest vertex. The searches from different sources are
+ independent, so they are run on several threads, each adding to its own totals, which
+ are summed in the end.
+
+ Exact betweenness takes a search from every vertex, O(V E + V^2 log V) time. The sampled
+ betweenness searches only from some randomly chosen pivot vertices and scales the result,
+ which gives the vertices with high betweenness well in a fraction of the time.
+
+ For undirected graphs each path is counted once, not once for each direction.
+ Weights must not be negative. The graph is copied to arrays when the object is made,
+ so later changes of the graph are not seen, and the dangling edges are not copied.
+ */
+template <typename T>
+class Betweenness {
+public:
+   Betweenness(const Graph<T> & graph, EdgeType type);
+
+   /// Betweenness of each vertex, in the order of vertices().
+   std::vector<double> exact(BetweennessPaths paths = EWeightedPaths, int threads = 1) const;
+   /// Approximate betweenness of each vertex from the searches of pivots random sources,
+   /// in the order of vertices(). The same seed gives the same pivots. With as many pivots
+   /// as vertices, this is the exact betweenness.
+   std::vector<double> sampled(int pivots, unsigned long seed, BetweennessPaths paths = EWeightedPaths, int threads = 1) const;
+
+   /// Vertices in the order of the graph's adjacencies.
+   const std::vector<Vertex<T>> & vertices() const;
+   /// Index of the vertex in vertices(), -1 if the vertex is not in the graph.
+   int indexOf(const Vertex<T> & vertex) const;
+
+private:
+   /// Arrays used by the searches of one thread, cleared after each search.
+   struct Workspace {
+      std::vector<double> distances;
+      std::vector<double> pathCounts;      // Number of shortest paths from the source.
+      std::vector<double> dependencies;
+      std::vector<int> positions;          // Position in order, -1 if not yet settled.
+      std::vector<int> order;              // Vertices in the order they were settled.
+   };
+   typedef std::pair<double, int> QueueElement;
+
+   /// Searches from the sources on the threads and sums the dependencies, times scale.
+   std::vector<double> accumulate(const std::vector<int> & sources, BetweennessPaths paths, int threads, double scale) const;
+   /// Adds the dependencies of the source on the other vertices to centrality.
+   void accumulateFrom(int source, BetweennessPaths paths, Workspace & work, std::vector<double> & centrality) const;
+
+   std::vector<Vertex<T>> graphVertices;
+   std::vector<std::size_t> offsets;     // Edges of vertex v are destinations[offsets[v]...offsets[v+1]-1].
+   std::vector<int> destinations;
+   std::vector<double> weights;
+   bool undirected;
+};
+
+
+template <typename T>
+Betweenness<T>::Betweenness(const Graph<T> & graph, EdgeType type)
+: undirected(type == EUndirected) {
+   graphVertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      graphVertices.push_back(vertexAndEdges.first);
+   }
+   offsets.reserve(graphVertices.size() + 1);
+   offsets.push_back(0);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = indexOf(edge.destination);
+         if (destination < 0) {
+            continue;
+         }
+         destinations.push_back(destination);
+         weights.push_back(edge.weight);
+      }
+      offsets.push_back(destinations.size());
+   }
+}
+
+template <typename T>
+std::vector<double> Betweenness<T>::exact(BetweennessPaths paths, int threads) const {
+   GRAPH_TRACE_SPAN("Betweenness::exact");
+   std::vector<int> sources(graphVertices.size());
+   std::iota(sources.begin(), sources.end(), 0);
+   return accumulate(sources, paths, threads, 1.0);
+}
+
+/*
+ Each pivot stands for vertexCount / pivots sources, so the sums are scaled by that.
+ */
+template <typename T>
+std::vector<double> Betweenness<T>::sampled(int pivots, unsigned long seed, BetweennessPaths paths, int threads) const {
+   GRAPH_TRACE_SPAN("Betweenness::sampled");
+   std::vector<int> sources(graphVertices.size());
+   std::iota(sources.begin(), sources.end(), 0);
+   std::size_t count = std::min(sources.size(), static_cast<std::size_t>(std::max(1, pivots)));
+   std::mt19937_64 random(seed);
+   for (std::size_t position = 0; position < count; position++) {
+      std::uniform_int_distribution<std::size_t> pick(position, sources.size() - 1);
+      std::swap(sources[position], sources[pick(random)]);
+   }
+   sources.resize(count);
+   double scale = count > 0 ? static_cast<double>(graphVertices.size()) / count : 1.0;
+   return accumulate(sources, paths, threads, scale);
+}
+
+template <typename T>
+const std::vector<Vertex<T>> & Betweenness<T>::vertices() const {
+   return graphVertices;
+}
+
+template <typename T>
+int Betweenness<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(graphVertices.begin(), graphVertices.end(), vertex);
+   if (found == graphVertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - graphVertices.begin());
+}
+
+/*
+ The threads take the sources one by one, so that threads getting the sources with
+ large searches do not hold up the others.
+ */
+template <typename T>
+std::vector<double> Betweenness<T>::accumulate(const std::vector<int> & sources, BetweennessPaths paths, int threads, double scale) const {
+   const std::size_t count = graphVertices.size();
+   threads = std::max(1, std::min(threads, static_cast<int>(sources.size())));
+   std::vector<std::vector<double>> totals(threads);
+   std::atomic<std::size_t> nextSource(0);
+   auto worker = [&](int thread) {
+      Workspace work;
+      work.distances.assign(count, std::numeric_limits<double>::infinity());
+      work.pathCounts.assign(count, 0.0);
+      work.dependencies.assign(count, 0.0);
+      work.positions.assign(count, -1);
+      totals[thread].assign(count, 0.0);
+      for (std::size_t source = nextSource++; source < sources.size(); source = nextSource++) {
+         accumulateFrom(sources[source], paths, work, totals[thread]);
+      }
+   };
+   std::vector<std::thread> pool;
+   for (int thread = 1; thread < threads; thread++) {
+      pool.emplace_back(worker, thread);
+   }
+   worker(0);
+   for (auto & thread : pool) {
+      thread.join();
+   }
+   std::vector<double> centrality(count, 0.0);
+   for (const auto & total : totals) {
+      for (std::size_t vertex = 0; vertex < count; vertex++) {
+         centrality[vertex] += total[vertex];
+      }
+   }
+   if (undirected) {
+      scale /= 2.0;
+   }
+   for (auto & value : centrality) {
+      value *= scale;
+   }
+   return centrality;
+}
+
+/*
+ The predecessors on the shortest paths are not stored. Going back in the settling order,
+ an edge v -> w is on a shortest path if w was settled after v and the distance of w is
+ the distance of v plus the edge. Each vertex then takes its share of the dependencies of
+ the vertices after it: dependency(v) = sum of paths(v) / paths(w) * (1 + dependency(w)).
+ */
+template <typename T>
+void Betweenness<T>::accumulateFrom(int source, BetweennessPaths paths, Workspace & work, std::vector<double> & centrality) const {
+   const bool weighted = paths == EWeightedPaths;
+   work.order.clear();
+   work.distances[source] = 0.0;
+   work.pathCounts[source] = 1.0;
+   if (weighted) {
+      std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+      queue.push(QueueElement(0.0, source));
+      while (!queue.empty()) {
+         auto [distance, vertex] = queue.top();
+         queue.pop();
+         if (work.positions[vertex] >= 0 || distance > work.distances[vertex]) {
+            continue;
+         }
+         work.positions[vertex] = static_cast<int>(work.order.size());
+         work.order.push_back(vertex);
+         for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+            int destination = destinations[edge];
+            double candidate = distance + weights[edge];
+            if (work.positions[destination] >= 0 || candidate > work.distances[destination]) {
+               continue;
+            }
+            if (candidate < work.distances[destination]) {
+               work.distances[destination] = candidate;
+               work.pathCounts[destination] = 0.0;
+               queue.push(QueueElement(candidate, destination));
+            }
+            work.pathCounts[destination] += work.pathCounts[vertex];
+         }
+      }
+   } else {
+      work.order.push_back(source);
+      for (std::size_t next = 0; next < work.order.size(); next++) {
+         int vertex = work.order[next];
+         work.positions[vertex] = static_cast<int>(next);
+         for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+            int destination = destinations[edge];
+            if (work.distances[destination] == std::numeric_limits<double>::infinity()) {
+               work.distances[destination] = work.distances[vertex] + 1.0;
+               work.order.push_back(destination);
+            }
+            if (work.distances[destination] == work.distances[vertex] + 1.0) {
+               work.pathCounts[destination] += work.pathCounts[vertex];
+            }
+         }
+      }
+   }
+   for (auto settled = work.order.rbegin(); settled != work.order.rend(); ++settled) {
+      int vertex = *settled;
+      double dependency = 0.0;
+      for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+         int destination = destinations[edge];
+         if (work.positions[destination] > work.positions[vertex] &&
+             work.distances[destination] == work.distances[vertex] + (weighted ? weights[edge] : 1.0)) {
+            dependency += work.pathCounts[vertex] / work.pathCounts[destination] * (1.0 + work.dependencies[destination]);
+         }
+      }
+      work.dependencies[vertex] = dependency;
+      if (vertex != source) {
+         centrality[vertex] += dependency;
+      }
+   }
+   for (int vertex : work.order) {
+      work.distances[vertex] = std::numeric_limits<double>::infinity();
+      work.pathCounts[vertex] = 0.0;
+      work.dependencies[vertex] = 0.0;
+      work.positions[vertex] = -1;
+   }
+}
+
+#endif /* Betweenness_hpp */
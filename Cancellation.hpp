@@ -0,0 +1,93 @@
+#ifndef Cancellation_hpp
+#define Cancellation_hpp
+
+#include <atomic>    // cancelled from another thread
+#include <chrono>
+
+/// Tells a search to stop, because its result is no longer needed or it took too long.
+/// A token is cancelled when cancel() is called, from any thread, or when its deadline passes.
+/// Searches taking a token check it while searching and stop soon after it is cancelled.
+class CancellationToken {
+public:
+   typedef std::chrono::steady_clock Clock;
+
+   /// A token without a deadline, cancelled only by cancel().
+   CancellationToken();
+   /// A token cancelled when the deadline passes.
+   explicit CancellationToken(Clock::time_point deadline);
+   CancellationToken(const CancellationToken &) = delete;
+   const CancellationToken & operator = (const CancellationToken &) = delete;
+
+   /// Cancels the searches using the token.
+   void cancel();
+   /// Has cancel() been called or the deadline passed.
+   bool isCancelled() const;
+   /// Has cancel() been called. Does not look at the clock.
+   bool isCancelRequested() const;
+   /// The deadline, Clock::time_point::max() if there is none.
+   Clock::time_point deadline() const;
+
+private:
+   std::atomic<bool> cancelled;
+   const Clock::time_point deadlineTime;
+};
+
+/// Checks a token from the loop of a search. The cancel flag is checked on every call,
+/// the clock on the first call and then every checkInterval calls, so the check costs
+/// little even in tight loops.
+/// Without a token, the check never stops the search.
+class CancellationCheck {
+public:
+   /// Calls between reading the clock. A search step takes at least tens of nanoseconds,
+   /// so the deadline is noticed within microseconds.
+   static constexpr unsigned checkInterval = 16;
+
+   CancellationCheck(const CancellationToken * token);
+   /// Should the search stop now.
+   bool shouldStop();
+
+private:
+   const CancellationToken * token;
+   unsigned calls;
+};
+
+
+inline CancellationToken::CancellationToken()
+: cancelled(false), deadlineTime(Clock::time_point::max()) {
+}
+
+inline CancellationToken::CancellationToken(Clock::time_point deadline)
+: cancelled(false), deadlineTime(deadline) {
+}
+
+inline void CancellationToken::cancel() {
+   cancelled.store(true, std::memory_order_relaxed);
+}
+
+inline bool CancellationToken::isCancelled() const {
+   return isCancelRequested() || (deadlineTime != Clock::time_point::max() && Clock::now() >= deadlineTime);
+}
+
+inline bool CancellationToken::isCancelRequested() const {
+   return cancelled.load(std::memory_order_relaxed);
+}
+
+inline CancellationToken::Clock::time_point CancellationToken::deadline() const {
+   return deadlineTime;
+}
+
+inline CancellationCheck::CancellationCheck(const CancellationToken * token)
+: token(token), calls(0) {
+}
+
+inline bool CancellationCheck::shouldStop() {
+   if (token == nullptr) {
+      return false;
+   }
+   if (calls++ % checkInterval == 0) {
+      return token->isCancelled();
+   }
+   return token->isCancelRequested();
+}
+
+#endif /* Cancellation_hpp */
@@ -0,0 +1,129 @@
+//
+//  main.cpp
+//  Client
+//
+//  Sends route queries to a lowestpath server (lowestpath file --serve socket)
+//  and prints the responses. Requests are sent without waiting for the responses,
+//  so the server can answer them in parallel.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+void printUsage();
+
+int main(int argc, const char * argv[]) {
+#if defined(__unix__) || defined(__APPLE__)
+   if (argc < 2 || argc > 3) {
+      printUsage();
+      return EXIT_FAILURE;
+   }
+   const std::string socketPath(argv[1]);
+   const std::string requestsPath(argc == 3 ? argv[2] : "-");
+   std::ifstream file;
+   if (requestsPath != "-") {
+      file.open(requestsPath);
+      if (!file) {
+         std::cerr << "Could not open " << requestsPath << std::endl;
+         return EXIT_FAILURE;
+      }
+   }
+   std::istream & requests = requestsPath == "-" ? std::cin : file;
+
+   sockaddr_un address;
+   std::memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (socketPath.size() >= sizeof(address.sun_path)) {
+      std::cerr << "Socket path is too long" << std::endl;
+      return EXIT_FAILURE;
+   }
+   std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+   int server = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (server < 0 || connect(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+      std::cerr << "Could not connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+      return EXIT_FAILURE;
+   }
+   std::signal(SIGPIPE, SIG_IGN);
+
+   auto started = std::chrono::steady_clock::now();
+   // Requests are written by another thread while this one reads the responses, so that
+   // neither side blocks when there are more requests than fit in the socket buffers.
+   long sent = 0;
+   std::thread writer([&requests, &sent, server] {
+      std::string batch;
+      auto send = [&batch, server] {
+         for (std::size_t written = 0; written < batch.size(); ) {
+            ssize_t count = write(server, batch.data() + written, batch.size() - written);
+            if (count <= 0) {
+               return false;
+            }
+            written += count;
+         }
+         batch.clear();
+         return true;
+      };
+      std::string line;
+      while (std::getline(requests, line)) {
+         if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+         }
+         if (line.empty() || line[0] == '#') {
+            continue;
+         }
+         batch += line;
+         batch += '\n';
+         // The server answers quit by closing the connection, and reads nothing after it.
+         if (line == "quit") {
+            break;
+         }
+         sent++;
+         // Send when the batch is big or no more input is available without waiting.
+         if ((batch.size() >= 65536 || requests.rdbuf()->in_avail() <= 0) && !send()) {
+            return;
+         }
+      }
+      send();
+      // Closing the sending side tells the server there are no more requests.
+      shutdown(server, SHUT_WR);
+   });
+
+   long received = 0;
+   char buffer[65536];
+   ssize_t count;
+   while ((count = read(server, buffer, sizeof(buffer))) > 0) {
+      std::cout.write(buffer, count);
+      for (ssize_t index = 0; index < count; index++) {
+         received += buffer[index] == '\n';
+      }
+   }
+   writer.join();
+   close(server);
+   std::cout.flush();
+   std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+   std::cerr << "Sent " << sent << " requests, received " << received << " responses in " << elapsed.count() << " ms" << std::endl;
+   return received == sent ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+   std::cerr << "lowestpathclient needs UNIX domain sockets, not available on this platform" << std::endl;
+   return EXIT_FAILURE;
+#endif
+}
+
+void printUsage() {
+   std::cerr << "Usage: lowestpathclient socket [requests]" << std::endl;
+   std::cerr << "  socket     the socket given to lowestpath --serve" << std::endl;
+   std::cerr << "  requests   file with one request per line, standard input if not given or -" << std::endl;
+   std::cerr << "Requests: lowest start target, shortest start target, pareto start target, close a b, open a b height, stats, ping, shutdown, quit" << std::endl;
+}
@@ -0,0 +1,384 @@
+#ifndef CompactGraph_hpp
+#define CompactGraph_hpp
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <memory>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+
+#include "Graph.hpp"
+#include "ShortestPathTree.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// The order the vertices of a CompactGraph are numbered in.
+enum VertexOrder {
+   EGraphOrder,            // Order of the graph's adjacencies, the order of the vertex data.
+   EBreadthFirstOrder,     // Order a breadth first search finds them, each connected part in turn.
+   ECuthillMcKeeOrder,     // Reverse Cuthill-McKee: breadth first, fewest edges first, reversed.
+   EDegreeOrder            // Vertices with the most edges first.
+};
+
+/// An edge of a CompactGraph: the number of the destination vertex and the weight.
+struct CompactEdge {
+   int destination;
+   double weight;
+};
+
+/**
+ A read only copy of a graph, with the vertices numbered 0...n-1 and the edges of all
+ vertices in one array, the edges of vertex v following the edges of vertex v-1.
+
+ The vertices of a Graph are in the order of their data, which has nothing to do with which
+ vertices are connected, so searches jump around in memory. Numbering the vertices so that
+ connected vertices get near numbers keeps the data of the vertices handled one after another
+ near each other in memory. Reverse Cuthill-McKee numbers the vertices so that the edges
+ are between vertices with near numbers; breadth first order has much the same effect.
+ Degree order puts the vertices with most edges, visited most often, together.
+
+ The edges of each vertex are in the order of the destination numbers. Edges to vertices
+ missing from the graph are left out. numberOf() and vertexAt() map between the vertices
+ and the numbers, and CompactSearch does the searches on the numbers.
+ */
+template <typename T>
+class CompactGraph {
+public:
+   typedef T DataType;
+
+   /// The edges of a vertex, to go through with a range for loop.
+   struct EdgeRange {
+      const CompactEdge * first;
+      const CompactEdge * last;
+      const CompactEdge * begin() const { return first; }
+      const CompactEdge * end() const { return last; }
+   };
+
+   /// Copies the graph, numbering the vertices in the order.
+   CompactGraph(const Graph<T> & graph, VertexOrder order = EGraphOrder);
+
+   /// Number of vertices.
+   int vertexCount() const;
+   /// Number of edges.
+   long edgeCount() const;
+   /// Number of the vertex, -1 if the vertex is not in the graph.
+   int numberOf(const Vertex<T> & vertex) const;
+   /// The vertex with the number.
+   const Vertex<T> & vertexAt(int number) const;
+   /// The edges from the vertex with the number.
+   EdgeRange edges(int number) const;
+
+   /// Vertices in the order of the graph's adjacencies, as in the ShortestPathTree of a Graph.
+   const std::vector<Vertex<T>> & graphVertices() const;
+   /// Index of the vertex with the number in the graphVertices().
+   int graphIndexOf(int number) const;
+   /// The average difference of the numbers of the vertices of an edge. The smaller it is,
+   /// the nearer the vertices handled one after another are to each other in memory.
+   double averageEdgeSpan() const;
+   /// Bytes used by the edges and their offsets, not counting the vertices.
+   std::size_t edgeBytes() const;
+
+private:
+   /// Gives the graph indices of the vertices in the order they are to be numbered.
+   static std::vector<int> orderOf(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations, VertexOrder order);
+
+   std::vector<Vertex<T>> vertices;       // Vertices in graph order.
+   std::vector<int> numbers;              // Number of each vertex in graph order.
+   std::vector<int> graphIndices;         // Graph order index of each number.
+   std::vector<std::size_t> offsets;      // Edges of number v are edgeArray[offsets[v]...offsets[v+1]-1].
+   std::vector<CompactEdge> edgeArray;
+};
+
+/// Searches on the vertex numbers of a CompactGraph, a CompressedGraph, or of any graph having the same
+/// vertexCount(), numberOf(), edges(), graphVertices() and graphIndexOf() functions.
+class CompactSearch {
+public:
+   /// Does a breadth first search from the vertex with the number. Gives the numbers of
+   /// the vertices in the order they were found, start first.
+   template <typename Compact>
+   static std::vector<int> breadthFirstSearchFrom(const Compact & graph, int start);
+
+   /// Finds the shortest paths from start with Dijkstra's algorithm. The tree uses the graph
+   /// order of the vertices, so it can be used like the trees given by Dijkstra for a Graph.
+   template <typename Compact>
+   static std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> shortestPathTreeFrom(const Compact & graph, const Vertex<typename Compact::DataType> & start);
+   /// Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   template <typename Compact>
+   static std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> shortestPathTreeFrom(const Compact & graph, const Vertex<typename Compact::DataType> & start, AlgorithmStats & stats);
+
+private:
+   template <typename Compact>
+   static std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> search(const Compact & graph, const Vertex<typename Compact::DataType> & start, AlgorithmStats * stats);
+};
+
+
+/*
+ The edges are first numbered in graph order, then the vertices are ordered using those,
+ and the edges are copied again in the new order with the new numbers.
+ */
+template <typename T>
+CompactGraph<T>::CompactGraph(const Graph<T> & graph, VertexOrder order) {
+   GRAPH_TRACE_SPAN("CompactGraph::CompactGraph");
+   vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+   }
+   const int count = static_cast<int>(vertices.size());
+   std::vector<std::size_t> graphOffsets(1, 0);
+   std::vector<int> graphDestinations;
+   std::vector<double> graphWeights;
+   graphOffsets.reserve(count + 1);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         auto found = std::lower_bound(vertices.begin(), vertices.end(), edge.destination);
+         if (found != vertices.end() && *found == edge.destination) {
+            graphDestinations.push_back(static_cast<int>(found - vertices.begin()));
+            graphWeights.push_back(edge.weight);
+         }
+      }
+      graphOffsets.push_back(graphDestinations.size());
+   }
+
+   graphIndices = orderOf(graphOffsets, graphDestinations, order);
+   numbers.resize(count);
+   for (int number = 0; number < count; number++) {
+      numbers[graphIndices[number]] = number;
+   }
+   offsets.reserve(count + 1);
+   offsets.push_back(0);
+   edgeArray.reserve(graphDestinations.size());
+   for (int number = 0; number < count; number++) {
+      int index = graphIndices[number];
+      for (std::size_t edge = graphOffsets[index]; edge < graphOffsets[index + 1]; edge++) {
+         edgeArray.push_back(CompactEdge{numbers[graphDestinations[edge]], graphWeights[edge]});
+      }
+      std::sort(edgeArray.begin() + offsets.back(), edgeArray.end(), [](const CompactEdge & one, const CompactEdge & another) {
+         return one.destination < another.destination;
+      });
+      offsets.push_back(edgeArray.size());
+   }
+}
+
+/*
+ All orders go through the vertices in graph order when choosing where to start, so the
+ numbering is always the same for the same graph.
+ */
+template <typename T>
+std::vector<int> CompactGraph<T>::orderOf(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations, VertexOrder order) {
+   const int count = static_cast<int>(offsets.size()) - 1;
+   std::vector<int> ordered(count);
+   for (int index = 0; index < count; index++) {
+      ordered[index] = index;
+   }
+   auto degree = [&offsets](int index) {
+      return offsets[index + 1] - offsets[index];
+   };
+   if (order == EGraphOrder) {
+      return ordered;
+   }
+   if (order == EDegreeOrder) {
+      std::stable_sort(ordered.begin(), ordered.end(), [&degree](int one, int another) {
+         return degree(one) > degree(another);
+      });
+      return ordered;
+   }
+   // Cuthill-McKee starts each part from a vertex with fewest edges, which is usually
+   // at the edge of the part, and visits the neighbours with fewer edges first.
+   std::vector<int> starts(ordered);
+   if (order == ECuthillMcKeeOrder) {
+      std::stable_sort(starts.begin(), starts.end(), [&degree](int one, int another) {
+         return degree(one) < degree(another);
+      });
+   }
+   std::vector<bool> found(count, false);
+   std::vector<int> neighbours;
+   ordered.clear();
+   for (int start : starts) {
+      if (found[start]) {
+         continue;
+      }
+      std::size_t next = ordered.size();
+      ordered.push_back(start);
+      found[start] = true;
+      while (next < ordered.size()) {
+         int index = ordered[next++];
+         neighbours.clear();
+         for (std::size_t edge = offsets[index]; edge < offsets[index + 1]; edge++) {
+            if (!found[destinations[edge]]) {
+               found[destinations[edge]] = true;
+               neighbours.push_back(destinations[edge]);
+            }
+         }
+         if (order == ECuthillMcKeeOrder) {
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&degree](int one, int another) {
+               return degree(one) < degree(another);
+            });
+         }
+         ordered.insert(ordered.end(), neighbours.begin(), neighbours.end());
+      }
+   }
+   if (order == ECuthillMcKeeOrder) {
+      std::reverse(ordered.begin(), ordered.end());
+   }
+   return ordered;
+}
+
+template <typename T>
+int CompactGraph<T>::vertexCount() const {
+   return static_cast<int>(vertices.size());
+}
+
+template <typename T>
+long CompactGraph<T>::edgeCount() const {
+   return static_cast<long>(edgeArray.size());
+}
+
+template <typename T>
+int CompactGraph<T>::numberOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return numbers[found - vertices.begin()];
+}
+
+template <typename T>
+const Vertex<T> & CompactGraph<T>::vertexAt(int number) const {
+   return vertices.at(graphIndices.at(number));
+}
+
+template <typename T>
+typename CompactGraph<T>::EdgeRange CompactGraph<T>::edges(int number) const {
+   return EdgeRange{edgeArray.data() + offsets[number], edgeArray.data() + offsets[number + 1]};
+}
+
+template <typename T>
+const std::vector<Vertex<T>> & CompactGraph<T>::graphVertices() const {
+   return vertices;
+}
+
+template <typename T>
+int CompactGraph<T>::graphIndexOf(int number) const {
+   return graphIndices[number];
+}
+
+template <typename T>
+double CompactGraph<T>::averageEdgeSpan() const {
+   if (edgeArray.empty()) {
+      return 0.0;
+   }
+   double sum = 0.0;
+   for (int number = 0; number < vertexCount(); number++) {
+      for (const auto & edge : edges(number)) {
+         sum += std::abs(edge.destination - number);
+      }
+   }
+   return sum / edgeArray.size();
+}
+
+template <typename T>
+std::size_t CompactGraph<T>::edgeBytes() const {
+   return edgeArray.size() * sizeof(CompactEdge) + offsets.size() * sizeof(std::size_t);
+}
+
+template <typename Compact>
+std::vector<int> CompactSearch::breadthFirstSearchFrom(const Compact & graph, int start) {
+   GRAPH_TRACE_SPAN("CompactSearch::breadthFirstSearchFrom");
+   std::vector<int> visited;
+   if (start < 0 || start >= graph.vertexCount()) {
+      return visited;
+   }
+   std::vector<bool> enqueued(graph.vertexCount(), false);
+   // The visited vertices are also the queue: the ones after next are still to be visited.
+   visited.push_back(start);
+   enqueued[start] = true;
+   for (std::size_t next = 0; next < visited.size(); next++) {
+      for (const auto & edge : graph.edges(visited[next])) {
+         if (!enqueued[edge.destination]) {
+            enqueued[edge.destination] = true;
+            visited.push_back(edge.destination);
+         }
+      }
+   }
+   return visited;
+}
+
+template <typename Compact>
+std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> CompactSearch::shortestPathTreeFrom(const Compact & graph, const Vertex<typename Compact::DataType> & start) {
+   return search(graph, start, nullptr);
+}
+
+template <typename Compact>
+std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> CompactSearch::shortestPathTreeFrom(const Compact & graph, const Vertex<typename Compact::DataType> & start, AlgorithmStats & stats) {
+   return search(graph, start, &stats);
+}
+
+/*
+ Same as Dijkstra::searchFrom with the shortest paths, but the search uses arrays indexed
+ by the vertex numbers, and the tree is filled from them in the order the vertices were
+ settled when the search is done.
+ */
+template <typename Compact>
+std::shared_ptr<const ShortestPathTree<typename Compact::DataType>> CompactSearch::search(const Compact & graph, const Vertex<typename Compact::DataType> & start, AlgorithmStats * stats) {
+   GRAPH_TRACE_SPAN("CompactSearch::shortestPathTreeFrom");
+   StatsTimer timer(stats);
+   typedef std::pair<double, int> QueueElement;
+   auto tree = std::make_shared<ShortestPathTree<typename Compact::DataType>>(graph.graphVertices());
+   int startNumber = graph.numberOf(start);
+   GRAPH_STATS_ADD(stats, lookups, 1);
+   if (startNumber < 0) {
+      return tree;
+   }
+   const int count = graph.vertexCount();
+   std::vector<double> distances(count, std::numeric_limits<double>::infinity());
+   std::vector<int> parents(count, -1);
+   std::vector<double> weights(count, 0.0);
+   std::vector<bool> settled(count, false);
+   std::vector<int> settledOrder;
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> priorityQueue;
+   distances[startNumber] = 0.0;
+   priorityQueue.push(QueueElement(0.0, startNumber));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   GrowthCounter queueGrowth(stats);
+   queueGrowth.sizeIs(priorityQueue.size());
+   while (!priorityQueue.empty()) {
+      auto [distance, number] = priorityQueue.top();
+      priorityQueue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[number]) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      settled[number] = true;
+      settledOrder.push_back(number);
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (const auto & edge : graph.edges(number)) {
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         if (settled[edge.destination]) {
+            continue;
+         }
+         double candidate = distance + edge.weight;
+         if (candidate < distances[edge.destination]) {
+            distances[edge.destination] = candidate;
+            parents[edge.destination] = number;
+            weights[edge.destination] = edge.weight;
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            priorityQueue.push(QueueElement(candidate, edge.destination));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(priorityQueue.size());
+         }
+      }
+   }
+   tree->setStart(graph.graphIndexOf(startNumber));
+   for (int number : settledOrder) {
+      if (parents[number] >= 0) {
+         tree->setParent(graph.graphIndexOf(number), graph.graphIndexOf(parents[number]), weights[number], distances[number]);
+      }
+      tree->settle(graph.graphIndexOf(number));
+   }
+   return tree;
+}
+
+#endif /* CompactGraph_hpp */
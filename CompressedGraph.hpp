@@ -0,0 +1,287 @@
+#ifndef CompressedGraph_hpp
+#define CompressedGraph_hpp
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "CompactGraph.hpp"
+
+/**
+ A read only graph with the edges compressed, to keep large graphs in less memory.
+ The edges are decoded while going through them, so CompactSearch can search the graph
+ as it is, without decompressing it first.
+
+ The edges of each vertex are sorted by the destination number, and each destination is
+ stored as the difference to the previous one (the first one to the number of the vertex
+ itself) as a variable length integer: 7 bits in each byte, the highest bit telling if more
+ bytes follow. With the vertices in an order keeping the connected vertices near each other,
+ like ECuthillMcKeeOrder, most destinations take one or two bytes instead of four.
+
+ Weights are stored as doubles by default. If weightStep is given, the weights are rounded
+ to multiples of it and stored as variable length integers, so e.g. whole number weights
+ below 128 take one byte with step 1.0. Rounding changes the weights by at most half a step.
+ */
+template <typename T>
+class CompressedGraph {
+public:
+   typedef T DataType;
+
+   /// Goes through the edges of a vertex, decoding them.
+   class EdgeIterator {
+   public:
+      typedef std::input_iterator_tag iterator_category;
+      typedef CompactEdge value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const CompactEdge * pointer;
+      typedef const CompactEdge & reference;
+
+      EdgeIterator(const std::uint8_t * position, const std::uint8_t * end, int vertex, double weightStep);
+      const CompactEdge & operator * () const;
+      const CompactEdge * operator -> () const;
+      EdgeIterator & operator ++ ();
+      bool operator == (const EdgeIterator & another) const;
+      bool operator != (const EdgeIterator & another) const;
+
+   private:
+      /// Decodes the edge at position, if not at the end.
+      void decode();
+
+      const std::uint8_t * position;   // The next edge to decode.
+      const std::uint8_t * next;       // The edge after the decoded one.
+      const std::uint8_t * end;
+      double weightStep;
+      CompactEdge edge;
+   };
+
+   /// The edges of a vertex, to go through with a range for loop.
+   struct EdgeRange {
+      EdgeIterator first;
+      EdgeIterator last;
+      EdgeIterator begin() const { return first; }
+      EdgeIterator end() const { return last; }
+   };
+
+   /// Compresses the compact graph. Zero weightStep keeps the weights as they are.
+   CompressedGraph(const CompactGraph<T> & compact, double weightStep = 0.0);
+   /// Compresses the graph, numbering the vertices in the order.
+   CompressedGraph(const Graph<T> & graph, VertexOrder order = ECuthillMcKeeOrder, double weightStep = 0.0);
+
+   /// Number of vertices.
+   int vertexCount() const;
+   /// Number of edges.
+   long edgeCount() const;
+   /// Number of the vertex, -1 if the vertex is not in the graph.
+   int numberOf(const Vertex<T> & vertex) const;
+   /// The vertex with the number.
+   const Vertex<T> & vertexAt(int number) const;
+   /// The edges from the vertex with the number.
+   EdgeRange edges(int number) const;
+
+   /// Vertices in the order of the graph's adjacencies, as in the ShortestPathTree of a Graph.
+   const std::vector<Vertex<T>> & graphVertices() const;
+   /// Index of the vertex with the number in the graphVertices().
+   int graphIndexOf(int number) const;
+   /// Bytes used by the compressed edges and their offsets, not counting the vertices.
+   std::size_t edgeBytes() const;
+
+private:
+   /// Appends the number as a variable length integer.
+   void appendVarint(std::uint64_t value);
+   /// Reads a variable length integer, moving position past it.
+   static std::uint64_t readVarint(const std::uint8_t * & position);
+   /// Maps signed numbers to unsigned ones so that small negative numbers stay small.
+   static std::uint64_t zigzag(std::int64_t value);
+   static std::int64_t unzigzag(std::uint64_t value);
+
+   void compress(const CompactGraph<T> & compact);
+
+   std::vector<Vertex<T>> vertices;       // Vertices in graph order.
+   std::vector<int> numbers;              // Number of each vertex in graph order.
+   std::vector<int> graphIndices;         // Graph order index of each number.
+   std::vector<std::size_t> offsets;      // Edges of number v are bytes[offsets[v]...offsets[v+1]-1].
+   std::vector<std::uint8_t> bytes;
+   long edgeTotal = 0;
+   double weightStep;
+};
+
+
+template <typename T>
+CompressedGraph<T>::CompressedGraph(const CompactGraph<T> & compact, double weightStep)
+: weightStep(weightStep) {
+   compress(compact);
+}
+
+template <typename T>
+CompressedGraph<T>::CompressedGraph(const Graph<T> & graph, VertexOrder order, double weightStep)
+: weightStep(weightStep) {
+   compress(CompactGraph<T>(graph, order));
+}
+
+/*
+ Each edge is the destination difference, and the weight either as 8 bytes of a double
+ or as a variable length integer. The differences are signed only for the first edge.
+ */
+template <typename T>
+void CompressedGraph<T>::compress(const CompactGraph<T> & compact) {
+   GRAPH_TRACE_SPAN("CompressedGraph::compress");
+   vertices = compact.graphVertices();
+   const int count = compact.vertexCount();
+   graphIndices.resize(count);
+   numbers.resize(count);
+   for (int number = 0; number < count; number++) {
+      graphIndices[number] = compact.graphIndexOf(number);
+      numbers[graphIndices[number]] = number;
+   }
+   offsets.reserve(count + 1);
+   offsets.push_back(0);
+   bytes.reserve(compact.edgeCount() * (weightStep > 0.0 ? 3 : 10));
+   for (int number = 0; number < count; number++) {
+      std::int64_t previous = number;
+      for (const auto & edge : compact.edges(number)) {
+         appendVarint(zigzag(edge.destination - previous));
+         previous = edge.destination;
+         if (weightStep > 0.0) {
+            appendVarint(zigzag(std::llround(edge.weight / weightStep)));
+         } else {
+            std::uint8_t weight[sizeof(double)];
+            std::memcpy(weight, &edge.weight, sizeof(double));
+            bytes.insert(bytes.end(), weight, weight + sizeof(double));
+         }
+         edgeTotal++;
+      }
+      offsets.push_back(bytes.size());
+   }
+   bytes.shrink_to_fit();
+}
+
+template <typename T>
+void CompressedGraph<T>::appendVarint(std::uint64_t value) {
+   while (value >= 0x80) {
+      bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+   }
+   bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+template <typename T>
+std::uint64_t CompressedGraph<T>::readVarint(const std::uint8_t * & position) {
+   std::uint64_t value = *position & 0x7f;
+   int shift = 7;
+   while (*position++ & 0x80) {
+      value |= static_cast<std::uint64_t>(*position & 0x7f) << shift;
+      shift += 7;
+   }
+   return value;
+}
+
+template <typename T>
+std::uint64_t CompressedGraph<T>::zigzag(std::int64_t value) {
+   return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+template <typename T>
+std::int64_t CompressedGraph<T>::unzigzag(std::uint64_t value) {
+   return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+template <typename T>
+int CompressedGraph<T>::vertexCount() const {
+   return static_cast<int>(vertices.size());
+}
+
+template <typename T>
+long CompressedGraph<T>::edgeCount() const {
+   return edgeTotal;
+}
+
+template <typename T>
+int CompressedGraph<T>::numberOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return numbers[found - vertices.begin()];
+}
+
+template <typename T>
+const Vertex<T> & CompressedGraph<T>::vertexAt(int number) const {
+   return vertices.at(graphIndices.at(number));
+}
+
+template <typename T>
+typename CompressedGraph<T>::EdgeRange CompressedGraph<T>::edges(int number) const {
+   const std::uint8_t * first = bytes.data() + offsets[number];
+   const std::uint8_t * last = bytes.data() + offsets[number + 1];
+   return EdgeRange{EdgeIterator(first, last, number, weightStep), EdgeIterator(last, last, number, weightStep)};
+}
+
+template <typename T>
+const std::vector<Vertex<T>> & CompressedGraph<T>::graphVertices() const {
+   return vertices;
+}
+
+template <typename T>
+int CompressedGraph<T>::graphIndexOf(int number) const {
+   return graphIndices[number];
+}
+
+template <typename T>
+std::size_t CompressedGraph<T>::edgeBytes() const {
+   return bytes.size() + offsets.size() * sizeof(std::size_t);
+}
+
+/*
+ The iterator keeps the destination of the decoded edge, the next one is relative to it.
+ */
+template <typename T>
+CompressedGraph<T>::EdgeIterator::EdgeIterator(const std::uint8_t * position, const std::uint8_t * end, int vertex, double weightStep)
+: position(position), next(position), end(end), weightStep(weightStep), edge{vertex, 0.0} {
+   decode();
+}
+
+template <typename T>
+const CompactEdge & CompressedGraph<T>::EdgeIterator::operator * () const {
+   return edge;
+}
+
+template <typename T>
+const CompactEdge * CompressedGraph<T>::EdgeIterator::operator -> () const {
+   return &edge;
+}
+
+template <typename T>
+typename CompressedGraph<T>::EdgeIterator & CompressedGraph<T>::EdgeIterator::operator ++ () {
+   position = next;
+   decode();
+   return *this;
+}
+
+template <typename T>
+bool CompressedGraph<T>::EdgeIterator::operator == (const EdgeIterator & another) const {
+   return position == another.position;
+}
+
+template <typename T>
+bool CompressedGraph<T>::EdgeIterator::operator != (const EdgeIterator & another) const {
+   return position != another.position;
+}
+
+template <typename T>
+void CompressedGraph<T>::EdgeIterator::decode() {
+   if (position == end) {
+      return;
+   }
+   next = position;
+   edge.destination += static_cast<int>(unzigzag(readVarint(next)));
+   if (weightStep > 0.0) {
+      edge.weight = unzigzag(readVarint(next)) * weightStep;
+   } else {
+      std::memcpy(&edge.weight, next, sizeof(double));
+      next += sizeof(double);
+   }
+}
+
+#endif /* CompressedGraph_hpp */
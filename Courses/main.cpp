@@ -12,6 +12,9 @@
 
 #include "Graph.hpp"
 #include "Dijkstra.hpp"
+#include "GraphView.hpp"
+#include "CriticalPath.hpp"
+#include "Reachability.hpp"
 #include "Course.hpp"
 
 // Helper funcs
@@ -56,15 +59,8 @@ int main(int argc, const char * argv[]) {
 	// MARK: - List courses that are not prerequisites
 	
 	std::cout << "Courses that are not a required preceding course in any other BSc course:\n";
-	std::vector<Vertex<Course>> allNodes = network.allVertices();
-	for (std::pair<Vertex<Course>, std::vector<Edge<Course>>> item : network.adjacencies) {
-		for (Edge<Course> edge : item.second) {
-			auto position = std::find(allNodes.begin(), allNodes.end(), edge.source);
-			if (position != allNodes.end()) {
-				allNodes.erase(position);
-			}
-		}
-	}
+	// Edges go from a course to the courses requiring it, so these have no outgoing edges.
+	std::vector<Vertex<Course>> allNodes = network.sinks();
 	if (!allNodes.empty()) {
 		for (Vertex<Course> vertex : allNodes) {
 			std::cout << " - " << vertex.data.code << ": ";
@@ -90,6 +86,13 @@ int main(int argc, const char * argv[]) {
 
    std::cout << std::endl << "Does the network have cycles?: " << (network.hasCycle(joti) ? "yes" : "no") << std::endl << std::endl;
 
+	// MARK: - Filtered view
+
+   // A view includes only some of the courses, without copying the graph.
+   GraphView<Course> firstYears(network, [](const Vertex<Course> & course) { return course.data.year <= 2; });
+   std::cout << "Breadth first search from JOTI, only courses of years 1 and 2" << std::endl;
+   printVertices(firstYears.breadthFirstSearchFrom(joti));
+
 	// MARK: - Do DFS from all vertices
 	
    // Take all vertices and do depth search for each of them, unless it already is included
@@ -134,6 +137,36 @@ int main(int argc, const char * argv[]) {
    }
    printVertices(topologicalList);
 
+	// MARK: - Reachability
+
+   // The index answers prerequisite questions without searching the graph each time.
+   Reachability<Course> prerequisites(network);
+   std::cout << " --- Is JOTI needed before LUKT: " << (prerequisites.reaches(joti, lukt) ? "yes" : "no") << std::endl;
+   std::cout << " --- Is OHJ1 needed before KAPO: " << (prerequisites.reaches(ohj1, kapo) ? "yes" : "no") << std::endl;
+   std::cout << " --- Is KAPO needed before OHJ1: " << (prerequisites.reaches(kapo, ohj1) ? "yes" : "no") << std::endl << std::endl;
+
+	// MARK: - Critical path
+
+   // Each edge is one period from a course to a course requiring it, so the longest chain
+   // of prerequisites tells the minimum number of periods to take all the courses.
+   std::cout << " --- Longest chain of prerequisite courses:" << std::endl << std::endl;
+   CriticalSchedule<Course> schedule = CriticalPath<Course>(network).analyze();
+   if (!schedule.acyclic) {
+      std::cout << "    No longest chain, the graph has cycles." << std::endl;
+   } else {
+      for (const auto & edge : schedule.path) {
+         std::wcout << std::right << std::setw(40) << edge.source.data.name << std::setw(6) << " --> ";
+         std::wcout << std::left << std::setw(40) << edge.destination.data.name << std::endl;
+      }
+      std::cout << std::endl << "Minimum number of periods to take all the courses: " << schedule.length + 1 << std::endl;
+      std::cout << "Courses that can be taken later without needing more periods:" << std::endl;
+      for (std::size_t index = 0; index < schedule.vertices.size(); index++) {
+         if (schedule.slack[index] > 0) {
+            std::cout << " - " << schedule.vertices[index].data.code << " up to " << schedule.slack[index] << " periods later" << std::endl;
+         }
+      }
+   }
+
    std::cout << std::endl << "<<<< Thank you for studying @ TOL! <<<<" << std::endl << std::endl;
    return EXIT_SUCCESS;
 }
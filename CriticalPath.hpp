@@ -0,0 +1,183 @@
+#ifndef CriticalPath_hpp
+#define CriticalPath_hpp
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "Graph.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// Result of CriticalPath::analyze. The vectors are in the order of the vertices.
+template <typename T>
+struct CriticalSchedule {
+   bool acyclic = true;               // False if the graph has cycles; then the rest is empty.
+   double length = 0.0;               // Length of the longest path in the graph.
+   std::vector<Vertex<T>> vertices;   // Vertices in the order of the graph's adjacencies.
+   std::vector<double> earliest;      // Longest path to the vertex from the vertices without incoming edges.
+   std::vector<double> latest;        // Latest the vertex can be reached without making the length longer.
+   std::vector<double> slack;         // Latest minus earliest, zero for the vertices on a critical path.
+   std::vector<Edge<T>> path;         // A longest (critical) path, from its first edge to its last.
+
+   /// Index of the vertex in vertices, -1 if the vertex is not in the graph.
+   int indexOf(const Vertex<T> & vertex) const;
+};
+
+/**
+ Finds the longest paths in a directed acyclic graph, like the longest chain of prerequisite
+ courses or of dependent tasks, in O(V + E) time.
+
+ With edges from a task to the tasks depending on it, weighted by the time between their
+ starts, the earliest of a vertex is the earliest its task can start, and the length is the
+ time all of them take. The latest is the latest the task can start without delaying the
+ end, and the slack tells how much the task can be delayed. Vertices with no slack are
+ critical: delaying any of them delays everything.
+
+ The vertices are put in topological order by removing the vertices without incoming edges
+ one by one (Kahn's algorithm), without recursion, so large graphs do not run out of stack.
+ The earliest times are then found going forward in the order and the latest going backward.
+ Weights may be negative, and dangling edges are skipped.
+ */
+template <typename T>
+class CriticalPath {
+public:
+   CriticalPath(const Graph<T> & graph);
+
+   /// Finds the longest paths and the slack of each vertex.
+   CriticalSchedule<T> analyze() const;
+   /// Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   CriticalSchedule<T> analyze(AlgorithmStats & stats) const;
+
+   // The graph to analyze.
+   const Graph<T> & graph;
+
+private:
+   CriticalSchedule<T> analyze(AlgorithmStats * stats) const;
+};
+
+
+template <typename T>
+int CriticalSchedule<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - vertices.begin());
+}
+
+template <typename T>
+CriticalPath<T>::CriticalPath(const Graph<T> & graph)
+: graph(graph) {
+}
+
+template <typename T>
+CriticalSchedule<T> CriticalPath<T>::analyze() const {
+   return analyze(nullptr);
+}
+
+template <typename T>
+CriticalSchedule<T> CriticalPath<T>::analyze(AlgorithmStats & stats) const {
+   return analyze(&stats);
+}
+
+/*
+ The edges are copied to arrays indexed by the vertex numbers first, so the passes over
+ them do not look up the vertices again. The parent of each vertex is the vertex before
+ it on its longest path; following the parents back from the vertex with the largest
+ earliest gives a critical path.
+ */
+template <typename T>
+CriticalSchedule<T> CriticalPath<T>::analyze(AlgorithmStats * stats) const {
+   GRAPH_TRACE_SPAN("CriticalPath::analyze");
+   StatsTimer timer(stats);
+   CriticalSchedule<T> schedule;
+   schedule.vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      schedule.vertices.push_back(vertexAndEdges.first);
+   }
+   const int count = static_cast<int>(schedule.vertices.size());
+   std::vector<std::size_t> offsets;
+   std::vector<int> destinations;
+   std::vector<double> weights;
+   std::vector<int> incoming(count, 0);
+   offsets.reserve(count + 1);
+   offsets.push_back(0);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = schedule.indexOf(edge.destination);
+         GRAPH_STATS_ADD(stats, lookups, 1);
+         if (destination < 0) {
+            continue;
+         }
+         destinations.push_back(destination);
+         weights.push_back(edge.weight);
+         incoming[destination]++;
+      }
+      offsets.push_back(destinations.size());
+   }
+
+   std::vector<int> order;
+   order.reserve(count);
+   for (int vertex = 0; vertex < count; vertex++) {
+      if (incoming[vertex] == 0) {
+         order.push_back(vertex);
+      }
+   }
+   schedule.earliest.assign(count, 0.0);
+   std::vector<int> parents(count, -1);
+   std::vector<double> parentWeights(count, 0.0);
+   for (std::size_t next = 0; next < order.size(); next++) {
+      int vertex = order[next];
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         int destination = destinations[edge];
+         double candidate = schedule.earliest[vertex] + weights[edge];
+         if (parents[destination] < 0 || candidate > schedule.earliest[destination]) {
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            schedule.earliest[destination] = candidate;
+            parents[destination] = vertex;
+            parentWeights[destination] = weights[edge];
+         }
+         if (--incoming[destination] == 0) {
+            order.push_back(destination);
+         }
+      }
+   }
+   if (static_cast<int>(order.size()) < count) {
+      // The vertices on the cycles never lost all their incoming edges.
+      CriticalSchedule<T> cyclic;
+      cyclic.acyclic = false;
+      return cyclic;
+   }
+
+   int end = -1;
+   for (int vertex = 0; vertex < count; vertex++) {
+      if (end < 0 || schedule.earliest[vertex] > schedule.earliest[end]) {
+         end = vertex;
+      }
+   }
+   schedule.length = end < 0 ? 0.0 : schedule.earliest[end];
+   // Longest path from each vertex, going backward in the order. Like the length, a path
+   // may end at any vertex, so the remaining is never negative.
+   std::vector<double> remaining(count, 0.0);
+   for (auto vertex = order.rbegin(); vertex != order.rend(); ++vertex) {
+      for (std::size_t edge = offsets[*vertex]; edge < offsets[*vertex + 1]; edge++) {
+         remaining[*vertex] = std::max(remaining[*vertex], weights[edge] + remaining[destinations[edge]]);
+      }
+   }
+   schedule.latest.resize(count);
+   schedule.slack.resize(count);
+   for (int vertex = 0; vertex < count; vertex++) {
+      schedule.latest[vertex] = schedule.length - remaining[vertex];
+      schedule.slack[vertex] = schedule.latest[vertex] - schedule.earliest[vertex];
+   }
+   for (int vertex = end; vertex >= 0 && parents[vertex] >= 0; vertex = parents[vertex]) {
+      schedule.path.push_back(Edge<T>(schedule.vertices[parents[vertex]], schedule.vertices[vertex], parentWeights[vertex]));
+   }
+   std::reverse(schedule.path.begin(), schedule.path.end());
+   return schedule;
+}
+
+#endif /* CriticalPath_hpp */
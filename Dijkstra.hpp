@@ -3,23 +3,15 @@
 
 #include <queue>
 #include <limits>
+#include <memory>
+#include <utility>
 
 #include "Graph.hpp"
-
-// Visiting paths are either of type Start (visiting starts) or
-// after starting from the first node, travelling between edges.
-enum VisitType {
-   EStart,
-   EEdge
-};
-
-// A visit has a type and when visiting between vertices (after the starting node)
-// also an edge.
-template <typename T>
-struct Visit {
-   VisitType type;
-   Edge<T> edge;
-};
+#include "GraphView.hpp"
+#include "Visit.hpp"
+#include "ShortestPathTree.hpp"
+#include "AlgorithmStats.hpp"
+#include "Cancellation.hpp"
 
 // Implementation of the Dijkstra algorithm.
 template <typename T>
@@ -27,6 +19,9 @@ class Dijkstra {
 public:
    // Algorithm is created by giving it an already existing graph to work with.
    Dijkstra(const Graph<T> & graph);
+   // Algorithm works on the vertices and edges of the view only. Results searched from a
+   // filtered view are not put to the graph's path cache. The view is copied, its filters are kept.
+   Dijkstra(const GraphView<T> & view);
 
    // Gives the Edges to get to a destination vertex using paths from vertices.
    std::vector<Edge<T>> route(const Vertex<T> & toDestination, const std::map<Vertex<T>, Visit<T>> & paths) const;
@@ -35,21 +30,56 @@ public:
    // Gives a max weight on route to destination from given vertex and paths.
    double maxWeight(const Vertex<T> & toDestination, const std::map<Vertex<T>, Visit<T>> & paths) const;
    // Gives a map of visiting paths from a starting vertex.
+   // Paths are taken from the graph's path cache if searched before from the same graph version.
    std::map<Vertex<T>, Visit<T>> shortestPathsFrom(const Vertex<T> & start) const;
    // Gives a map of visiting paths from a starting vertex.
+   // Paths are taken from the graph's path cache if searched before from the same graph version.
    std::map<Vertex<T>, Visit<T>> lowestPathsFrom(const Vertex<T> & start) const;
+   // Gives the tree of shortest paths (sum of the weights) from a starting vertex.
+   // The tree may be shared with the graph's path cache.
+   std::shared_ptr<const ShortestPathTree<T>> shortestPathTreeFrom(const Vertex<T> & start) const;
+   // Gives the tree of lowest paths (lowest max weight) from a starting vertex.
+   // The tree may be shared with the graph's path cache.
+   std::shared_ptr<const ShortestPathTree<T>> lowestPathTreeFrom(const Vertex<T> & start) const;
+   // Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   std::shared_ptr<const ShortestPathTree<T>> shortestPathTreeFrom(const Vertex<T> & start, AlgorithmStats & stats) const;
+   std::shared_ptr<const ShortestPathTree<T>> lowestPathTreeFrom(const Vertex<T> & start, AlgorithmStats & stats) const;
+   // Like above, stopping the search when the token is cancelled or its deadline passes.
+   // Returns nullptr if the search was stopped before it was done.
+   std::shared_ptr<const ShortestPathTree<T>> shortestPathTreeFrom(const Vertex<T> & start, const CancellationToken & token) const;
+   std::shared_ptr<const ShortestPathTree<T>> lowestPathTreeFrom(const Vertex<T> & start, const CancellationToken & token) const;
    // Gives an array of edges as the shortest path to a destination using several paths as a starting point.
    std::vector<Edge<T>> shortestPathTo(const Vertex<T> & destination, const std::map<Vertex<T>, Visit<T>> & paths) const;
+   // Gives an array of edges as the shortest path to a destination using a path tree.
+   std::vector<Edge<T>> shortestPathTo(const Vertex<T> & destination, const ShortestPathTree<T> & tree) const;
 
    // The graph to use to find the shortest path.
    const Graph<T> & graph;
+
+private:
+   // The part of the graph used, all of it unless a filtered view was given.
+   GraphView<T> view;
+
+   // Distance found to a vertex and the index of the vertex, see searchFrom().
+   typedef std::pair<double, int> QueueElement;
+   typedef std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> SearchQueue;
+
+   // Does the search, unless the result is already in the path cache.
+   std::shared_ptr<const ShortestPathTree<T>> searchFrom(const Vertex<T> & start, PathAlgorithm algorithm, AlgorithmStats * stats = nullptr, const CancellationToken * token = nullptr) const;
+   // Converts a path tree to the map of visits.
+   std::map<Vertex<T>, Visit<T>> pathsOf(const ShortestPathTree<T> & tree) const;
 };
 
 // Constructor copies the graph from the parameter to be used by Dijkstra algorithm.
 // Original graph is not touched.
 template <typename T>
 Dijkstra<T>::Dijkstra(const Graph<T> & graph)
-: graph(graph) {
+: graph(graph), view(graph) {
+}
+
+template <typename T>
+Dijkstra<T>::Dijkstra(const GraphView<T> & view)
+: graph(view.graph), view(view) {
 }
 
 // Finds a route to a destination using given paths.
@@ -96,57 +126,108 @@ double Dijkstra<T>::maxWeight(const Vertex<T> & toDestination, const std::map<Ve
 
 
 /*
- A comparator function object.
- This is needed in shortestPathFrom function.
- Without a comparator, priority queue uses the < operator in the Vertex
- to order the elements. In this case, we want the priority queue to order
- the elements based on the _Edge weights_. So we must tell that to the priority queue.
-
- So the priority queue is used to keep the vertices in order of distance.
- Priority queues in std library allow us to give it a comparator function object
- so that we can tell the priority queue how to order the elements in the queue.
- Usually the implementation is simple, we just compare items in the priority queue
- using some item value or item operator <. But in this case, the Vertex does not
- have any data member we can use in the comparison, but we need the distance from
- or to the vertex using a _path_. This is why we have to give the comparator function
- object additional things to enable it to calculate the distance of paths from
- a vertex. So the comparator is given
- - the Dijkstra object -- so that it can call the distance function, and
- - the path -- since it contains the paths of which the distance is calculated.
- You can see this used in shortestPathFrom function below when it creates the
- std::priority_queue to use. That queue is give this distance_compare function object
- it then uses in keeping the Vertices in the priority queue in order of the distance
- from the vertex via various paths.
- */
-template <typename T>
-struct distance_compare {
-   // A constructor we can use to give the Dijkstra and path objects to the comparator.
-   distance_compare(const Dijkstra<T> & d, const std::map<Vertex<T>, Visit<T>> & p)
-   : dijkstra(d), paths(p) { /* Empty implementation */ };
-   // The actual operator std::priority_queue uses to compare the elements in the queue.
-   bool operator () (const Vertex<T> & lhs, const Vertex<T> & rhs) {
-      return dijkstra.distance(lhs, paths) < dijkstra.distance(rhs, paths);
-   };
-   const Dijkstra<T> & dijkstra;                   // Comparator needs this to call distance()
-   const std::map<Vertex<T>, Visit<T>> & paths;    // Comparator needs this to calculate the distance.
-};
+ QueueElement is an element in the priority queue of the search: the distance found
+ to a vertex and the index of the vertex.
 
-/*
- Like distance_compare, but this comparison looks for lowest weight on the path.
+ std::priority_queue is a _max_ priority queue, so it is given std::greater as the
+ comparator to make it a _min_ priority queue; top() then gives the vertex with the
+ smallest distance. Pairs compare first by the distance and then by the index.
+
+ The queue does not support changing the priority of an element already in the queue.
+ So when a shorter path to a vertex is found, the vertex is pushed again with the new
+ distance. The older element stays in the queue, and when it is later popped it is
+ ignored since its distance is larger than the distance already in the tree.
+
+ searchFrom finds the shortest (or lowest) paths from start to all vertices reachable from it.
+ Vertices are numbered in the order of the graph's adjacencies, so the index of the
+ destination of an edge can be found with binary search without creating any lookup tables.
+ Dangling edges are skipped.
+ If stats is given, the work done is counted to it (when compiled with GRAPH_STATS).
+ If token is given, it is checked for each vertex numbered and settled, and a search stopped by it
+ returns nullptr. The paths of a stopped search are not complete, so they are not cached.
  */
 template <typename T>
-struct path_weight_compare {
-   // A constructor we can use to give the Dijkstra and path objects to the comparator.
-   path_weight_compare(const Dijkstra<T> & d, const std::map<Vertex<T>, Visit<T>> & p)
-   : dijkstra(d), paths(p) { /* Empty implementation */ };
-   // The actual operator std::priority_queue uses to compare the elements in the queue.
-   bool operator () (const Vertex<T> & lhs, const Vertex<T> & rhs) {
-      return dijkstra.maxWeight(lhs, paths) > dijkstra.maxWeight(rhs, paths);
-   };
-   const Dijkstra<T> & dijkstra;                   // Comparator needs this to call distance()
-   const std::map<Vertex<T>, Visit<T>> & paths;    // Comparator needs this to calculate the distance.
-};
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::searchFrom(const Vertex<T> & start, PathAlgorithm algorithm, AlgorithmStats * stats, const CancellationToken * token) const {
+   GRAPH_TRACE_SPAN(algorithm == PathAlgorithm::EShortestPaths ? "Dijkstra::shortestPathsFrom" : "Dijkstra::lowestPathsFrom");
+   StatsTimer timer(stats);
+   // Paths in the cache were searched from the whole graph, so they are not used for filtered views.
+   const bool filtered = view.isFiltered();
+   // If the paths from start were already searched from this version of the graph, use those.
+   auto cached = filtered ? nullptr : graph.pathCache.find(start, graph.version(), algorithm);
+   GRAPH_STATS_ADD(stats, lookups, 1);
+   if (cached) {
+      GRAPH_STATS_ADD(stats, cacheHits, 1);
+      return cached;
+   }
+   CancellationCheck cancellation(token);
+   // Number the vertices and keep a pointer to the edges of each so no map lookups are needed later.
+   std::vector<Vertex<T>> vertices;
+   std::vector<const std::vector<Edge<T>> *> edgeLists;
+   vertices.reserve(graph.adjacencies.size());
+   edgeLists.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      if (cancellation.shouldStop()) {
+         return nullptr;
+      }
+      vertices.push_back(vertexAndEdges.first);
+      edgeLists.push_back(&vertexAndEdges.second);
+   }
+   auto tree = std::make_shared<ShortestPathTree<T>>(vertices);
+   int startIndex = tree->indexOf(start);
+   GRAPH_STATS_ADD(stats, lookups, 1);
+   if (startIndex < 0 || (filtered && !view.includes(vertices[startIndex]))) {
+      return tree;   // Start is not in the graph, so nothing can be reached.
+   }
+   std::vector<bool> settled(vertices.size(), false);
+   SearchQueue priorityQueue;
+   tree->setStart(startIndex);
+   priorityQueue.push(QueueElement(0.0, startIndex));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   GrowthCounter queueGrowth(stats);
+   queueGrowth.sizeIs(priorityQueue.size());
 
+   while (!priorityQueue.empty()) {                   // While there are vertices in the queue.
+      if (cancellation.shouldStop()) {
+         return nullptr;
+      }
+      auto [distance, index] = priorityQueue.top();   // Take the vertex having the shortest distance out.
+      priorityQueue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[index]) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;                                    // Already found a shorter path to this one.
+      }
+      settled[index] = true;                          // Path to this vertex is now final.
+      tree->settle(index);
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (const auto & edge : *edgeLists[index]) {   // For each edge...
+         int destination = tree->indexOf(edge.destination);
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         GRAPH_STATS_ADD(stats, lookups, 1);
+         if (destination < 0 || settled[destination] || (filtered && !view.includes(edge))) {
+            continue;
+         }
+         // Distance via this vertex is either the sum of the weights or the highest weight on the path.
+         double candidate = algorithm == PathAlgorithm::EShortestPaths
+                            ? distance + edge.weight
+                            : std::max(distance, edge.weight);
+         // If this is a shorter path to the edge's destination than found before, use this edge
+         // to get there and push the edge's destination to the priority queue.
+         if (candidate < tree->distanceTo(destination)) {
+            tree->setParent(destination, index, edge.weight, candidate);
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            priorityQueue.push(QueueElement(candidate, destination));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(priorityQueue.size());
+         }
+      }
+   }
+   // Remember the paths for the next search from the same start vertex.
+   if (!filtered) {
+      graph.pathCache.insert(start, graph.version(), algorithm, tree);
+   }
+   return tree;
+}
 
 /*
  Function finds the shortest paths from a starting vertex, and returns the paths in a map
@@ -154,78 +235,66 @@ struct path_weight_compare {
  */
 template <typename T>
 std::map<Vertex<T>, Visit<T>> Dijkstra<T>::shortestPathsFrom(const Vertex<T> & start) const {
-   Visit<T> visit;
-   visit.type = VisitType::EStart;
-   std::map<Vertex<T>, Visit<T>> paths;  // The result returned from this function; shortest paths from start.
-   // First insert the starting visiting edge to the path.
-   paths.insert( { graph.adjacencies.find(start)->first, visit } );
-   //  ↑                                    ↑              ↑
-   // Key-value table              The key (Vertex)   The value (Visit)
-   
-   // Create a priority queue sorting the vertices in the order of path distances from the vertex.
-   std::priority_queue<Vertex<T>, std::vector<Vertex<T>>, distance_compare<T>> priorityQueue(distance_compare(*this, paths));
-   // When we push vertices in the priority queue, they are then automatically arranged in the order of path distance (length).
-   priorityQueue.push(graph.adjacencies.find(start)->first);
-
-   // Start from the starting vertex already in the queue.
-   while (!priorityQueue.empty()) {                   // While there are vertices in the queue.
-      auto vertex = priorityQueue.top();              // Take the vertice having the shortest distance out.
-      priorityQueue.pop();
-      auto edges = graph.edges(vertex);               // Get the edges of this vertex
-      for (const auto & edge : edges) {               // For each edge...
-         double weight = edge.weight;
-         // If the edge's destination has not yet been added to paths _or_
-         // the distance of the vertex path + current edge's length is _smaller_ than the distance of the
-         // edge's destination's paths, then add the edge's destination to the paths as an edge type visit
-         // and push the edge's destination to the priority queue.
-         if (paths.find(edge.destination) == paths.end() ||
-             distance(vertex, paths) + weight < distance(edge.destination, paths)) {
-            paths[edge.destination].type = VisitType::EEdge;
-            paths[edge.destination].edge = edge;
-            priorityQueue.push(edge.destination);
-         }
-      }
-   }
-   return paths;
+   return pathsOf(*searchFrom(start, PathAlgorithm::EShortestPaths));
 }
 
 /*
- A variant of shortestPathsFrom. In this method, the goai is to get the path where the edges have
+ A variant of shortestPathsFrom. In this method, the goal is to get the path where the edges have
  the max weight that has the lowest possible value.
  */
 template <typename T>
 std::map<Vertex<T>, Visit<T>> Dijkstra<T>::lowestPathsFrom(const Vertex<T> & start) const {
-   Visit<T> visit;
-   visit.type = VisitType::EStart;
-   std::map<Vertex<T>, Visit<T>> paths;  // The result returned from this function; lowest paths from start.
-                                         // First insert the starting visiting edge to the path.
-   paths.insert( { graph.adjacencies.find(start)->first, visit } );
-   //  ↑                                    ↑              ↑
-   // Key-value table              The key (Vertex)   The value (Visit)
-
-   // Create a priority queue sorting the vertices in the order of lowest paths by weight from the vertex.
-   std::priority_queue<Vertex<T>, std::vector<Vertex<T>>, path_weight_compare<T>> priorityQueue(path_weight_compare(*this, paths));
-   // When we push vertices in the priority queue, they are then automatically arranged in the order of path weight.
-   priorityQueue.push(graph.adjacencies.find(start)->first);
-
-   // Start from the starting vertex already in the queue.
-   while (!priorityQueue.empty()) {                   // While there are vertices int he queue.
-      auto vertex = priorityQueue.top();              // Take the vertice having the lowest weight out.
-      priorityQueue.pop();
-      auto edges = graph.edges(vertex);               // Get the edges of this vertex
-      for (const auto & edge : edges) {               // For each edge...
-         double weight = edge.weight;
-         // If the edge's destination has not yet been added to paths _or_
-         // the weight of the path path + current edge's length is _smaller_ than the weight of the
-         // edge's destination's paths, then add the edge's destination to the paths as an edge type visit
-         // and push the edge's destination to the priority queue.
-         if (paths.find(edge.destination) == paths.end() ||
-             maxWeight(vertex, paths) + weight < maxWeight(edge.destination, paths)) {
-            paths[edge.destination].type = VisitType::EEdge;
-            paths[edge.destination].edge = edge;
-            priorityQueue.push(edge.destination);
-         }
+   return pathsOf(*searchFrom(start, PathAlgorithm::ELowestPaths));
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::shortestPathTreeFrom(const Vertex<T> & start) const {
+   return searchFrom(start, PathAlgorithm::EShortestPaths);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::lowestPathTreeFrom(const Vertex<T> & start) const {
+   return searchFrom(start, PathAlgorithm::ELowestPaths);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::shortestPathTreeFrom(const Vertex<T> & start, AlgorithmStats & stats) const {
+   return searchFrom(start, PathAlgorithm::EShortestPaths, &stats);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::lowestPathTreeFrom(const Vertex<T> & start, AlgorithmStats & stats) const {
+   return searchFrom(start, PathAlgorithm::ELowestPaths, &stats);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::shortestPathTreeFrom(const Vertex<T> & start, const CancellationToken & token) const {
+   return searchFrom(start, PathAlgorithm::EShortestPaths, nullptr, &token);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> Dijkstra<T>::lowestPathTreeFrom(const Vertex<T> & start, const CancellationToken & token) const {
+   return searchFrom(start, PathAlgorithm::ELowestPaths, nullptr, &token);
+}
+
+/*
+ Converts the tree to the map of visits, each visit having the edge from the parent vertex.
+ */
+template <typename T>
+std::map<Vertex<T>, Visit<T>> Dijkstra<T>::pathsOf(const ShortestPathTree<T> & tree) const {
+   std::map<Vertex<T>, Visit<T>> paths;
+   for (int index : tree) {
+      const Vertex<T> & vertex = tree.vertexAt(index);
+      int parent = tree.parentOf(index);
+      // The start has no edge from a parent, so it gets an edge to itself instead of an uninitialized one.
+      Visit<T> visit = { VisitType::EStart, Edge<T>(vertex, vertex, 0.0) };
+      if (parent >= 0) {
+         visit.type = VisitType::EEdge;
+         visit.edge = Edge<T>(tree.vertexAt(parent), vertex, tree.weightTo(index));
       }
+      paths.insert( { vertex, visit } );
+      //  ↑               ↑                    ↑
+      // Key-value table  The key (Vertex)   The value (Visit)
    }
    return paths;
 }
@@ -235,4 +304,20 @@ std::vector<Edge<T>> Dijkstra<T>::shortestPathTo(const Vertex<T> & destination,
    return route(destination, paths);
 }
 
+/*
+ Like the map version, gives the edges from the destination back to the start.
+ */
+template <typename T>
+std::vector<Edge<T>> Dijkstra<T>::shortestPathTo(const Vertex<T> & destination, const ShortestPathTree<T> & tree) const {
+   std::vector<Edge<T>> path;
+   int index = tree.indexOf(destination);
+   if (index < 0 || !tree.reaches(index)) {
+      return path;
+   }
+   for (int parent = tree.parentOf(index); parent >= 0; index = parent, parent = tree.parentOf(index)) {
+      path.push_back(Edge<T>(tree.vertexAt(parent), tree.vertexAt(index), tree.weightTo(index)));
+   }
+   return path;
+}
+
 #endif
@@ -0,0 +1,178 @@
+//
+//  main.cpp
+//  Generator
+//
+//  Generates synthetic graphs in the LowestPath text format, in the
+//  binary format of GraphFile.hpp, for testing lowestpath with large inputs,
+//  or in the memory mapped format of MappedGraph.hpp.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <cstdio>
+
+#include "GraphGenerator.hpp"
+#include "GraphFile.hpp"
+#include "MappedGraph.hpp"
+
+void printUsage();
+
+int main(int argc, const char * argv[]) {
+   std::string type = "heightmap";
+   std::string format = "text";
+   std::string weights = "uniform";
+   std::string outputPath;
+   long vertices = 1000;
+   long edges = 0;
+   int width = 0;
+   int height = 0;
+   int neighbours = 3;
+   int maxWeight = 100;
+   int target = 0;
+   bool connect = true;
+   unsigned long seed = 1;
+
+   for (int arg = 1; arg < argc; arg++) {
+      std::string option(argv[arg]);
+      if (arg + 1 >= argc) {
+         printUsage();
+         return EXIT_FAILURE;
+      }
+      std::string value(argv[++arg]);
+      if (option == "--type") {
+         type = value;
+      } else if (option == "--format") {
+         format = value;
+      } else if (option == "--weights") {
+         weights = value;
+      } else if (option == "--output") {
+         outputPath = value;
+      } else if (option == "--vertices") {
+         vertices = std::atol(value.c_str());
+      } else if (option == "--edges") {
+         edges = std::atol(value.c_str());
+      } else if (option == "--width") {
+         width = std::atoi(value.c_str());
+      } else if (option == "--height") {
+         height = std::atoi(value.c_str());
+      } else if (option == "--neighbours") {
+         neighbours = std::atoi(value.c_str());
+      } else if (option == "--max-weight") {
+         maxWeight = std::atoi(value.c_str());
+      } else if (option == "--target") {
+         target = std::atoi(value.c_str());
+      } else if (option == "--connect") {
+         connect = value != "no" && value != "0";
+      } else if (option == "--seed") {
+         seed = std::strtoul(value.c_str(), nullptr, 10);
+      } else {
+         printUsage();
+         return EXIT_FAILURE;
+      }
+   }
+
+   WeightDistribution distribution = EUniformWeights;
+   if (weights == "exponential") {
+      distribution = EExponentialWeights;
+   } else if (weights == "normal") {
+      distribution = ENormalWeights;
+   } else if (weights != "uniform") {
+      printUsage();
+      return EXIT_FAILURE;
+   }
+   if (vertices < 2 || vertices > std::numeric_limits<int>::max() || (format != "text" && format != "binary" && format != "mapped") ||
+       (format == "mapped" && outputPath.empty())) {
+      printUsage();
+      return EXIT_FAILURE;
+   }
+
+   auto started = std::chrono::steady_clock::now();
+   GraphGenerator generator(seed, maxWeight, distribution);
+   std::vector<GeneratedEdge> generated;
+   int vertexCount = static_cast<int>(vertices);
+   if (type == "heightmap" || type == "grid") {
+      // Without width and height, use a square grid with about the requested number of vertices.
+      if (width <= 0 || height <= 0) {
+         width = height = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(vertices))));
+      }
+      vertexCount = width * height;
+      generated = type == "grid" ? generator.grid(width, height) : generator.heightMap(width, height);
+   } else if (type == "random") {
+      generated = generator.randomSparse(vertexCount, edges > 0 ? edges : 2 * vertices);
+   } else if (type == "rmat") {
+      int scale = std::max(1, static_cast<int>(std::ceil(std::log2(static_cast<double>(vertices)))));
+      vertexCount = 1 << scale;
+      generated = generator.powerLaw(scale, edges > 0 ? edges : 2L * vertexCount);
+   } else if (type == "road") {
+      generated = generator.road(vertexCount, neighbours);
+   } else {
+      printUsage();
+      return EXIT_FAILURE;
+   }
+   // Random graphs usually have small separate parts; link those so every target can be reached.
+   if (connect) {
+      generator.connect(vertexCount, generated);
+   }
+   if (target <= 0 || target > vertexCount) {
+      target = vertexCount;
+   }
+
+   bool written = false;
+   if (format == "mapped") {
+#if defined(__unix__) || defined(__APPLE__)
+      // The mapped file is made from a binary file, which is removed when done.
+      std::string binaryPath = outputPath + ".bin";
+      std::fstream binary(binaryPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+      written = binary && GraphFile::writeBinary(binary, vertexCount, generated, target) &&
+                binary.seekg(0) && MappedGraph::convert(binary, outputPath);
+      binary.close();
+      std::remove(binaryPath.c_str());
+#else
+      std::cerr << "The mapped format needs memory mapped files, not available on this platform" << std::endl;
+      return EXIT_FAILURE;
+#endif
+   } else {
+      std::ofstream file;
+      if (!outputPath.empty()) {
+         file.open(outputPath, std::ios::binary);
+         if (!file) {
+            std::cerr << "Could not open " << outputPath << " for writing" << std::endl;
+            return EXIT_FAILURE;
+         }
+      }
+      std::ostream & output = outputPath.empty() ? std::cout : file;
+      written = format == "binary"
+                ? GraphFile::writeBinary(output, vertexCount, generated, target)
+                : GraphFile::writeText(output, vertexCount, generated, target);
+      output.flush();
+   }
+   if (!written) {
+      std::cerr << "Writing the graph failed" << std::endl;
+      return EXIT_FAILURE;
+   }
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+   std::cerr << "Generated " << type << " graph with " << vertexCount << " vertices and " << generated.size()
+             << " edges in " << elapsed.count() << " s" << std::endl;
+   return EXIT_SUCCESS;
+}
+
+void printUsage() {
+   std::cerr << "Usage: graphgenerator [options]" << std::endl;
+   std::cerr << "  --type heightmap|grid|random|rmat|road   kind of graph (heightmap)" << std::endl;
+   std::cerr << "  --vertices n                             approximate number of vertices (1000)" << std::endl;
+   std::cerr << "  --edges m                                edges for random and rmat (2 x vertices)" << std::endl;
+   std::cerr << "  --width w --height h                     grid size for heightmap and grid" << std::endl;
+   std::cerr << "  --neighbours k                           nearest neighbours connected in road (3)" << std::endl;
+   std::cerr << "  --weights uniform|exponential|normal     weight distribution (uniform)" << std::endl;
+   std::cerr << "  --max-weight w                           weights are between 1 and w (100)" << std::endl;
+   std::cerr << "  --seed s                                 same seed gives the same graph (1)" << std::endl;
+   std::cerr << "  --connect yes|no                         link separate parts of the graph (yes)" << std::endl;
+   std::cerr << "  --target t                               target city on the last line (last vertex)" << std::endl;
+   std::cerr << "  --format text|binary|mapped              LowestPath text or binary format, or MappedGraph file (text)" << std::endl;
+   std::cerr << "  --output file                            file to write, standard output if not given (required for mapped)" << std::endl;
+}
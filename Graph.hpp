@@ -15,9 +15,14 @@
 #include <set>       // unordered collection, helper container used in some algos
 #include <stack>     // basic stack, used in many places when going through the graph.
 #include <algorithm> // algorithms such as std::find etc.
+#include <thread>    // building the graph in parallel
 
 #include "Vertex.hpp"   // a node for the graph
 #include "Edge.hpp"     // an edge of the graph, from node to another
+#include "PathCache.hpp" // cached path search results of the graph
+#include "IncomingEdges.hpp" // edges coming into the vertices
+#include "Trace.hpp"     // tracing spans, compiled in with GRAPH_TRACE
+#include "Cancellation.hpp" // stopping long searches
 
 enum EdgeType {
    EDirected,        // Edge is directed, one way only
@@ -40,11 +45,25 @@ public:
 
    /// Add an edge with type (directional, undirectional) from source to destination (and possibly back).
    void add(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination, double weight);
+   /// Replaces the vertices and edges of the graph with the edges and their vertices, using the
+   /// threads to sort them. The graph is the same as when adding the edges one by one with add().
+   void buildFrom(const std::vector<Edge<T>> & edges, EdgeType edgeType, int threads = 1);
    /// Add an undirected edge from source to destination vertex, using a weight.
    void addUndirectedEdge(const Vertex<T> & source, const Vertex<T> & destination, double weight);
    /// Add a directed edge from source to destination vertex.
    void addDirectedEdge(const Vertex<T> & source, const Vertex<T> & destination, double weight);
 
+   /// Removes the edge from source to destination (and back, if undirected).
+   /// Returns false if there was no edge to remove.
+   bool removeEdge(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination);
+   /// Removes the vertex with the edges from and to it. Returns false if there is no such vertex.
+   bool removeVertex(const Vertex<T> & vertex);
+   /// Changes the weight of the edge from source to destination (and back, if undirected).
+   /// Returns false if there was no edge to change.
+   bool updateWeight(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination, double weight);
+   /// Releases the memory left unused by removed vertices and edges.
+   void compact();
+
 	/// Checks if the vertex already has an edge with specified destination vertex.
 	bool hasDestination(const Vertex<T> & vertex, const Vertex<T> & destination) const;
 
@@ -54,12 +73,29 @@ public:
 
    /// Get all the edges from a vertex.
    const std::vector<Edge<T>> & edges(const Vertex<T> & fromSource) const;
+   /// Get all the edges coming into a vertex. The source of the edges is where they come from.
+   const std::vector<Edge<T>> & incomingEdges(const Vertex<T> & toDestination) const;
+   /// Gets the number of edges coming into the vertex.
+   std::size_t inDegree(const Vertex<T> & vertex) const;
+   /// Gets the number of edges going out of the vertex.
+   std::size_t outDegree(const Vertex<T> & vertex) const;
+   /// Gets the vertices with no incoming edges.
+   std::vector<Vertex<T>> sources() const;
+   /// Gets the vertices with no outgoing edges.
+   std::vector<Vertex<T>> sinks() const;
+   /// Keeps the incoming edges up to date as vertices and edges are added and removed, instead of
+   /// finding them again from all the edges after the graph has changed.
+   void maintainIncomingEdges(bool maintain = true);
+
    /// Gets the weight of the edge from source to destination.
    /// Returns zero if there is no edge from source to destination.
    double weight(const Vertex<T> & fromSource, const Vertex<T> & toDestination) const;
 
    /// Does a breadth first search from vertex through the graph.
    std::vector<Vertex<T>> breadthFirstSearchFrom(const Vertex<T> & from) const;
+   /// Does a breadth first search, stopping when the token is cancelled or its deadline passes.
+   /// Gives the vertices visited before stopping; check the token to know if the search was stopped.
+   std::vector<Vertex<T>> breadthFirstSearchFrom(const Vertex<T> & from, const CancellationToken & token) const;
    /// Does a depth first search from vertex through the graph.
    std::vector<Vertex<T>> depthFirstSearchFrom(const Vertex<T> & from) const;
 
@@ -77,10 +113,46 @@ public:
    /// Topological sort with DFS
    std::vector<Vertex<T>> topologicalSort() const;
 
+   /// Gets the version of the graph. Version changes each time vertices or edges are
+   /// added or removed using the member functions. Modifying adjacencies directly does not
+   /// change the version, so call touch() after doing that.
+   unsigned long version() const;
+   /// Marks the graph changed, invalidating the cached path search results.
+   void touch();
+
    /// Associative table; a dictionary where a Vertex has an array of edges.
+   /// When the table is modified directly, an edge may lead to a vertex that is not a key of
+   /// it. Such a dangling edge leads nowhere: the searches numbering the vertices, like Dijkstra,
+   /// skip it, but the other algorithms of Graph expect every destination to be a vertex.
    std::map<Vertex<T>, std::vector<Edge<T>>> adjacencies;
 
+   /// Least recently used path search results, consulted by Dijkstra.
+   mutable PathCache<T> pathCache;
+
 private:
+   /// Edges coming into the vertices, used by incomingEdges() and the functions using it.
+   IncomingEdges<T> incoming;
+
+   /// Incremented each time the graph changes.
+   unsigned long mutationVersion = 0;
+
+   /// Removes a directed edge, returns false if there was none.
+   bool removeDirectedEdge(const Vertex<T> & source, const Vertex<T> & destination);
+   /// Changes the weight of a directed edge, returns false if there was none.
+   bool updateDirectedWeight(const Vertex<T> & source, const Vertex<T> & destination, double weight);
+   /// Releases the unused memory of the edges if most of it is unused after removals.
+   void shrinkIfSparse(std::vector<Edge<T>> & edges);
+
+   /// Calls work(begin, end) for parts of the range 0...count, in parallel using the threads.
+   template <typename Work>
+   static void inParallel(std::size_t count, int threads, Work work);
+   /// Sorts the range, sorting parts of it in parallel and then merging them.
+   template <typename Iterator, typename Compare>
+   static void parallelSort(Iterator begin, Iterator end, Compare compare, int threads);
+
+   /// Breadth first search, checking the token if one is given.
+   std::vector<Vertex<T>> breadthFirstSearch(const Vertex<T> & from, const CancellationToken * token) const;
+
    /// Helper function for numberOfPathsFrom().
    void pathsFrom(const Vertex<T> & source, const Vertex<T> & destination, std::set<Vertex<T>> & visited, int & pathCount) const;
 
@@ -103,6 +175,8 @@ void Graph<T>::addDirectedEdge(const Vertex<T> & source, const Vertex<T> & desti
 	if (!hasDestination(source, destination)) {
 		Edge<T> edge = Edge<T>(source, destination, weight);
 		adjacencies.at(source).push_back(edge);
+		touch();
+		incoming.edgeAdded(edge, mutationVersion - 1, mutationVersion);
 	}
 }
 
@@ -115,6 +189,7 @@ void Graph<T>::addUndirectedEdge(const Vertex<T> & source, const Vertex<T> & des
 
 template <typename T>
 void Graph<T>::add(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination, double weight) {
+   GRAPH_TRACE_SPAN("Graph::add");
    switch (edge) {
       case EDirected:
          addDirectedEdge(source, destination, weight);
@@ -125,6 +200,286 @@ void Graph<T>::add(EdgeType edge, const Vertex<T> & source, const Vertex<T> & de
    }
 }
 
+/*
+ Edges of a vertex are in their own array, so an edge is removed by erasing it from the
+ array of its source. Erasing keeps the order of the other edges, so the searches go
+ through them in the same order as before, and costs about the same as finding the edge.
+ */
+template <typename T>
+bool Graph<T>::removeDirectedEdge(const Vertex<T> & source, const Vertex<T> & destination) {
+   auto found = adjacencies.find(source);
+   if (found == adjacencies.end()) {
+      return false;
+   }
+   auto & edgesArray = found->second;
+   auto position = std::find_if(edgesArray.begin(), edgesArray.end(), [&destination](const Edge<T> & edge) {
+      return edge.destination == destination;
+   });
+   if (position == edgesArray.end()) {
+      return false;
+   }
+   Edge<T> edge = *position;
+   edgesArray.erase(position);
+   shrinkIfSparse(edgesArray);
+   touch();
+   incoming.edgeRemoved(edge, mutationVersion - 1, mutationVersion);
+   return true;
+}
+
+template <typename T>
+bool Graph<T>::removeEdge(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination) {
+   bool removed = removeDirectedEdge(source, destination);
+   if (edge == EUndirected) {
+      removed = removeDirectedEdge(destination, source) || removed;
+   }
+   return removed;
+}
+
+/*
+ The edges coming to the vertex are found from the incoming edges, so the edges of
+ all the other vertices need not be searched. The removals are applied to the incoming
+ edges even when they are not maintained, so removing many vertices builds them once,
+ unless edges or vertices are added between the removals.
+ */
+template <typename T>
+bool Graph<T>::removeVertex(const Vertex<T> & vertex) {
+   auto found = adjacencies.find(vertex);
+   if (found == adjacencies.end()) {
+      return false;
+   }
+   std::vector<Vertex<T>> predecessors;
+   for (const auto & edge : incomingEdges(vertex)) {
+      predecessors.push_back(edge.source);
+   }
+   for (const auto & predecessor : predecessors) {
+      removeDirectedEdge(predecessor, vertex);
+   }
+   // Removing the vertex removes the edges from it, but those are in the incoming edges of the others.
+   for (const auto & edge : found->second) {
+      incoming.edgeRemoved(edge, mutationVersion, mutationVersion);
+   }
+   adjacencies.erase(found);
+   touch();
+   incoming.vertexRemoved(vertex, mutationVersion - 1, mutationVersion);
+   return true;
+}
+
+template <typename T>
+bool Graph<T>::updateDirectedWeight(const Vertex<T> & source, const Vertex<T> & destination, double weight) {
+   auto found = adjacencies.find(source);
+   if (found == adjacencies.end()) {
+      return false;
+   }
+   for (auto & edge : found->second) {
+      if (edge.destination == destination) {
+         edge.weight = weight;
+         touch();
+         incoming.weightUpdated(edge, mutationVersion - 1, mutationVersion);
+         return true;
+      }
+   }
+   return false;
+}
+
+template <typename T>
+bool Graph<T>::updateWeight(EdgeType edge, const Vertex<T> & source, const Vertex<T> & destination, double weight) {
+   bool updated = updateDirectedWeight(source, destination, weight);
+   if (edge == EUndirected) {
+      updated = updateDirectedWeight(destination, source, weight) || updated;
+   }
+   return updated;
+}
+
+/*
+ Arrays of edges shrink when three quarters of their memory is unused, so the memory
+ follows the number of edges, and the copying is paid by the removals done before it.
+ */
+template <typename T>
+void Graph<T>::shrinkIfSparse(std::vector<Edge<T>> & edges) {
+   if (edges.capacity() >= 16 && edges.size() < edges.capacity() / 4) {
+      edges.shrink_to_fit();
+   }
+}
+
+/*
+ Removals shrink the arrays of edges only when they are mostly unused,
+ this releases all the unused memory. Cached search results are dropped.
+ */
+template <typename T>
+void Graph<T>::compact() {
+   for (auto & vertexAndEdges : adjacencies) {
+      vertexAndEdges.second.shrink_to_fit();
+   }
+   pathCache.clear();
+   incoming.compact();
+}
+
+/*
+ Instead of finding the source vertex and the duplicates for each edge added, the edges
+ are sorted by the source and destination, so that duplicates are next to each other and
+ the edges of a vertex follow each other. The first of the duplicates is kept, like add()
+ does, and the edges of a vertex are put back to the order they were given in. Vertices
+ are then put in the map in order and the arrays of edges are filled in parallel.
+ The sorted entries hold the vertices, not pointers to them, so that comparing them
+ does not jump around in memory.
+ */
+template <typename T>
+void Graph<T>::buildFrom(const std::vector<Edge<T>> & edges, EdgeType edgeType, int threads) {
+   GRAPH_TRACE_SPAN("Graph::buildFrom");
+   struct Entry {
+      Vertex<T> source;
+      Vertex<T> destination;
+      double weight;
+      std::size_t order;
+   };
+   const std::size_t directions = edgeType == EUndirected ? 2 : 1;
+   std::vector<Entry> entries(edges.size() * directions);
+   inParallel(edges.size(), threads, [&edges, &entries, directions](std::size_t begin, std::size_t end) {
+      for (std::size_t index = begin; index < end; index++) {
+         const Edge<T> & edge = edges[index];
+         std::size_t order = index * directions;
+         entries[order] = Entry{edge.source, edge.destination, edge.weight, order};
+         if (directions == 2) {
+            entries[order + 1] = Entry{edge.destination, edge.source, edge.weight, order + 1};
+         }
+      }
+   });
+   parallelSort(entries.begin(), entries.end(), [](const Entry & first, const Entry & second) {
+      if (first.source < second.source) {
+         return true;
+      }
+      if (second.source < first.source) {
+         return false;
+      }
+      if (first.destination < second.destination) {
+         return true;
+      }
+      if (second.destination < first.destination) {
+         return false;
+      }
+      return first.order < second.order;
+   }, threads);
+   entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry & first, const Entry & second) {
+      return first.source == second.source && first.destination == second.destination;
+   }), entries.end());
+
+   // Where the edges of each source vertex begin in the entries.
+   std::vector<std::size_t> sourceBegins;
+   for (std::size_t index = 0; index < entries.size(); index++) {
+      if (index == 0 || !(entries[index - 1].source == entries[index].source)) {
+         sourceBegins.push_back(index);
+      }
+   }
+   sourceBegins.push_back(entries.size());
+   // Vertices that are only destinations need to be in the graph too. When the edges are
+   // undirected, each destination is also a source.
+   std::vector<Vertex<T>> destinations;
+   if (edgeType == EDirected) {
+      destinations.reserve(entries.size());
+      for (const auto & entry : entries) {
+         destinations.push_back(entry.destination);
+      }
+      parallelSort(destinations.begin(), destinations.end(), std::less<Vertex<T>>(), threads);
+      destinations.erase(std::unique(destinations.begin(), destinations.end()), destinations.end());
+   }
+
+   adjacencies.clear();
+   std::vector<std::vector<Edge<T>> *> sourceEdges;
+   sourceEdges.reserve(sourceBegins.size() - 1);
+   auto destination = destinations.begin();
+   for (std::size_t source = 0; source + 1 < sourceBegins.size(); source++) {
+      const Vertex<T> & vertex = entries[sourceBegins[source]].source;
+      for ( ; destination != destinations.end() && *destination < vertex; ++destination) {
+         adjacencies.emplace_hint(adjacencies.end(), *destination, std::vector<Edge<T>>());
+      }
+      if (destination != destinations.end() && *destination == vertex) {
+         ++destination;
+      }
+      auto added = adjacencies.emplace_hint(adjacencies.end(), vertex, std::vector<Edge<T>>());
+      sourceEdges.push_back(&added->second);
+   }
+   for ( ; destination != destinations.end(); ++destination) {
+      adjacencies.emplace_hint(adjacencies.end(), *destination, std::vector<Edge<T>>());
+   }
+   inParallel(sourceEdges.size(), threads, [&entries, &sourceBegins, &sourceEdges](std::size_t begin, std::size_t end) {
+      for (std::size_t source = begin; source < end; source++) {
+         auto first = entries.begin() + sourceBegins[source];
+         auto last = entries.begin() + sourceBegins[source + 1];
+         std::sort(first, last, [](const Entry & one, const Entry & another) {
+            return one.order < another.order;
+         });
+         auto & edgesArray = *sourceEdges[source];
+         edgesArray.reserve(last - first);
+         for (auto entry = first; entry != last; ++entry) {
+            edgesArray.emplace_back(entry->source, entry->destination, entry->weight);
+         }
+      }
+   });
+   touch();
+}
+
+/*
+ The calling thread does the first part, and a thread is started for each of the others.
+ */
+template <typename T>
+template <typename Work>
+void Graph<T>::inParallel(std::size_t count, int threads, Work work) {
+   std::size_t parts = static_cast<std::size_t>(std::max(1, threads));
+   parts = std::max<std::size_t>(1, std::min(parts, count / 1024));
+   std::vector<std::thread> pool;
+   for (std::size_t part = 1; part < parts; part++) {
+      pool.emplace_back(work, count * part / parts, count * (part + 1) / parts);
+   }
+   work(0, count / parts);
+   for (auto & thread : pool) {
+      thread.join();
+   }
+}
+
+/*
+ Each thread sorts one part, then the sorted parts are merged pairwise in rounds,
+ the merges of a round in parallel, until there is one sorted range.
+ */
+template <typename T>
+template <typename Iterator, typename Compare>
+void Graph<T>::parallelSort(Iterator begin, Iterator end, Compare compare, int threads) {
+   std::size_t count = end - begin;
+   std::size_t parts = static_cast<std::size_t>(std::max(1, threads));
+   parts = std::max<std::size_t>(1, std::min(parts, count / 1024));
+   std::vector<std::size_t> bounds;
+   for (std::size_t part = 0; part <= parts; part++) {
+      bounds.push_back(count * part / parts);
+   }
+   std::vector<std::thread> sorters;
+   for (std::size_t part = 1; part < parts; part++) {
+      sorters.emplace_back([&begin, &compare](std::size_t first, std::size_t last) {
+         std::sort(begin + first, begin + last, compare);
+      }, bounds[part], bounds[part + 1]);
+   }
+   std::sort(begin, begin + bounds[1], compare);
+   for (auto & thread : sorters) {
+      thread.join();
+   }
+   while (bounds.size() > 2) {
+      std::vector<std::size_t> merged;
+      std::vector<std::thread> pool;
+      for (std::size_t part = 0; part + 2 < bounds.size(); part += 2) {
+         pool.emplace_back([&begin, &compare](std::size_t first, std::size_t middle, std::size_t last) {
+            std::inplace_merge(begin + first, begin + middle, begin + last, compare);
+         }, bounds[part], bounds[part + 1], bounds[part + 2]);
+         merged.push_back(bounds[part]);
+      }
+      if (bounds.size() % 2 == 0) {
+         merged.push_back(bounds[bounds.size() - 2]);
+      }
+      merged.push_back(bounds.back());
+      for (auto & thread : pool) {
+         thread.join();
+      }
+      bounds = merged;
+   }
+}
+
 template <typename T>
 bool Graph<T>::hasDestination(const Vertex<T> & vertex, const Vertex<T> & destination) const {
 	for (const auto & edge : edges(vertex)) {
@@ -141,14 +496,19 @@ bool Graph<T>::hasDestination(const Vertex<T> & vertex, const Vertex<T> & destin
  */
 template <typename T>
 Vertex<T> Graph<T>::createVertex(const T & data) {
+   GRAPH_TRACE_SPAN("Graph::createVertex");
    Vertex<T> vertex = Vertex<T>(data);
-   adjacencies.insert(std::pair<Vertex<T>, std::vector<Edge<T>>>(vertex, {}));
+   if (adjacencies.insert(std::pair<Vertex<T>, std::vector<Edge<T>>>(vertex, {})).second) {
+      touch();
+      incoming.vertexAdded(vertex, mutationVersion - 1, mutationVersion);
+   }
    return vertex;
 }
 
 template <typename T>
 void Graph<T>::clear() {
 	adjacencies.clear();
+	touch();
 }
 
 /*
@@ -159,6 +519,21 @@ void Graph<T>::copyVerticesFrom(const Graph<T> & graph) {
    for (const auto & vertexAndEdges : graph.adjacencies) {
       adjacencies[vertexAndEdges.first] = {};
    }
+   touch();
+}
+
+template <typename T>
+unsigned long Graph<T>::version() const {
+   return mutationVersion;
+}
+
+/*
+ Moves the graph to a new version. Cached paths are keyed by the version,
+ so the paths searched from the earlier versions are not used anymore.
+ */
+template <typename T>
+void Graph<T>::touch() {
+   mutationVersion++;
 }
 
 /*
@@ -170,6 +545,59 @@ const std::vector<Edge<T>> & Graph<T>::edges(const Vertex<T> & fromSource) const
    return adjacencies.at(fromSource);
 }
 
+/*
+ Retrieve the edges coming into a vertex from the index of incoming edges,
+ which is built from all the edges if the graph has changed since it was built.
+ */
+template <typename T>
+const std::vector<Edge<T>> & Graph<T>::incomingEdges(const Vertex<T> & toDestination) const {
+   return incoming.of(adjacencies, mutationVersion).at(toDestination);
+}
+
+template <typename T>
+std::size_t Graph<T>::inDegree(const Vertex<T> & vertex) const {
+   return incomingEdges(vertex).size();
+}
+
+template <typename T>
+std::size_t Graph<T>::outDegree(const Vertex<T> & vertex) const {
+   return edges(vertex).size();
+}
+
+template <typename T>
+std::vector<Vertex<T>> Graph<T>::sources() const {
+   std::vector<Vertex<T>> vertices;
+   for (const auto & vertexAndEdges : incoming.of(adjacencies, mutationVersion)) {
+      if (vertexAndEdges.second.empty()) {
+         vertices.push_back(vertexAndEdges.first);
+      }
+   }
+   return vertices;
+}
+
+template <typename T>
+std::vector<Vertex<T>> Graph<T>::sinks() const {
+   std::vector<Vertex<T>> vertices;
+   for (const auto & vertexAndEdges : adjacencies) {
+      if (vertexAndEdges.second.empty()) {
+         vertices.push_back(vertexAndEdges.first);
+      }
+   }
+   return vertices;
+}
+
+/*
+ When starting to maintain, the index is built now so that the additions
+ after this can be added to it.
+ */
+template <typename T>
+void Graph<T>::maintainIncomingEdges(bool maintain) {
+   incoming.setMaintained(maintain);
+   if (maintain) {
+      incoming.of(adjacencies, mutationVersion);
+   }
+}
+
 /*
  For a source vertex, get the weight of the destination vertex if there is an edge from
  the source to the destination. If there is no edge, returns 0.0.
@@ -193,7 +621,7 @@ double Graph<T>::weight(const Vertex<T> & fromSource, const Vertex<T> & toDestin
 /// Streams the adjacency list to an output stream.
 template <typename T>
 std::ostream & operator << (std::ostream & stream, const Graph<T> & adjacencyList) {
-   std::cout << "Edge list for the network with weights between <>:" << std::endl;
+   stream << "Edge list for the network with weights between <>:\n";
    for (auto const& [key, values] : adjacencyList.adjacencies) {
       stream << key << " ---> [ ";
       int counter = 0;
@@ -204,13 +632,24 @@ std::ostream & operator << (std::ostream & stream, const Graph<T> & adjacencyLis
             stream << ", ";
          }
       }
-      stream << " ]" << std::endl;
+      stream << " ]\n";
    }
    return stream;
 }
 
 template <typename T>
 std::vector<Vertex<T>> Graph<T>::breadthFirstSearchFrom(const Vertex<T> & from) const {
+   return breadthFirstSearch(from, nullptr);
+}
+
+template <typename T>
+std::vector<Vertex<T>> Graph<T>::breadthFirstSearchFrom(const Vertex<T> & from, const CancellationToken & token) const {
+   return breadthFirstSearch(from, &token);
+}
+
+template <typename T>
+std::vector<Vertex<T>> Graph<T>::breadthFirstSearch(const Vertex<T> & from, const CancellationToken * token) const {
+   GRAPH_TRACE_SPAN("Graph::breadthFirstSearchFrom");
    std::queue<Vertex<T>> queue;     // vertices to visit next
    std::set<Vertex<T>> enqueued;    // vertices already found and marked to be visited
    std::vector<Vertex<T>> visited;  // All visited vertices
@@ -218,8 +657,9 @@ std::vector<Vertex<T>> Graph<T>::breadthFirstSearchFrom(const Vertex<T> & from)
    // Start from the provided vertex.
    queue.push(from);          // Push to vertices to visit
    enqueued.insert(from);     // and mark that is either visited or marked to be visited.
+   CancellationCheck cancellation(token);
 
-   while (!queue.empty()) {                        // Are there vertices to visit?
+   while (!queue.empty() && !cancellation.shouldStop()) {   // Are there vertices to visit?
       auto vertex = queue.front();                 // Take the next one
       queue.pop();
       visited.push_back(adjacencies.find(vertex)->first);                   // Add it to the visited.
@@ -236,6 +676,7 @@ std::vector<Vertex<T>> Graph<T>::breadthFirstSearchFrom(const Vertex<T> & from)
 
 template <typename T>
 std::vector<Vertex<T>> Graph<T>::depthFirstSearchFrom(const Vertex<T> & from) const {
+   GRAPH_TRACE_SPAN("Graph::depthFirstSearchFrom");
    std::stack<Vertex<T>> stack;        // vertices to depth search.
    std::set<Vertex<T>> pushed;         // Not yet handled in depth search
    std::vector<Vertex<T>> visited;     // vertices visited in depth search
@@ -381,6 +822,7 @@ bool Graph<T>::hasCycle(const Vertex<T> & source, std::set<Vertex<T>> & pushed)
 
 template <typename T>
 std::vector<Vertex<T>> Graph<T>::topologicalSort() const {
+   GRAPH_TRACE_SPAN("Graph::topologicalSort");
    // This list will contain the nodes in topological sort order
    std::vector<Vertex<T>> topologicalList;
    // Nodes handling in process
@@ -388,22 +830,9 @@ std::vector<Vertex<T>> Graph<T>::topologicalSort() const {
    // Processed nodes
    std::set<Vertex<T>> blackNodes;
 
-   // Go through all the nodes in the graph, removing vertices
-	// that have an incoming edge. Do topological sort only for those
-	// vertices that have incoming edge.
-   std::vector<Vertex<T>> allNodes = allVertices();
-	for (std::pair<Vertex<T>, std::vector<Edge<T>>> item : adjacencies) {
-		for (Edge<T> edge : item.second) {
-			auto position = std::find(allNodes.begin(), allNodes.end(), edge.destination);
-			if (position != allNodes.end()) {
-				allNodes.erase(position);
-			}
-		}
-	}
-   while (!allNodes.empty()) {
-      // While still nodes to handle, get one from the list
-      Vertex<T> node = allNodes.front();
-      allNodes.erase(allNodes.begin());
+   // Do topological sort starting from the vertices that have no incoming edges.
+   // If there are none, the graph has cycles and the list stays empty.
+   for (const auto & node : sources()) {
       // Does the DFS topological sort if not already handled for this node.
       if (blackNodes.find(node) == blackNodes.end()) {
          // If returns false, could not do this because cycles.
@@ -413,6 +842,8 @@ std::vector<Vertex<T>> Graph<T>::topologicalSort() const {
          }
       }
    }
+   // Nodes were added as they were finished, and the last finished comes first.
+   std::reverse(topologicalList.begin(), topologicalList.end());
    return topologicalList;
 }
 
@@ -443,8 +874,8 @@ bool Graph<T>::topologicalSortDFS(const Vertex<T> & from,
    // Node processed so remove it from grays and add to blacks.
    grayNodes.erase(from);
    blackNodes.insert(from);
-   // And put the node in the beginning of the list.
-   topoList.insert(topoList.begin(),from);
+   // And put the node in the list, reversed when the sort is done.
+   topoList.push_back(from);
    return true;
 }
 
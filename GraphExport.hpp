@@ -0,0 +1,254 @@
+#ifndef GraphExport_hpp
+#define GraphExport_hpp
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <charconv>  // to_chars, fast number formatting without locales
+
+#include "Graph.hpp"
+
+/// Formats supported by GraphExport::write.
+enum ExportFormat {
+   EDotFormat,       // GraphViz DOT, for drawing the graph with dot or neato.
+   EEdgeListFormat,  // One "source destination weight" line per edge.
+   ECsvFormat        // Comma separated values with a header line.
+};
+
+/// Writes graphs for other tools: GraphViz DOT, plain edge lists and CSV.
+///
+/// The exporters go through the adjacency lists of the graph and format the vertices and
+/// weights straight into a large buffer, which is written to the stream when nearly full.
+/// Nothing is flushed per line, so graphs with millions of edges are written in seconds.
+/// Integer and string vertex data is formatted without temporary strings; other types are
+/// formatted with their operator <<, without the trailing spaces those usually print.
+///
+/// Undirected graphs hold each edge in both directions. With EUndirected, each edge is
+/// written once, from the smaller vertex to the larger one. Minimum spanning trees from
+/// Prim are undirected graphs.
+class GraphExport {
+public:
+   /// Writes the graph in the GraphViz DOT language. Vertices without edges are written too.
+   template <typename T>
+   static bool writeDot(std::ostream & stream, const Graph<T> & graph, EdgeType type = EDirected, const std::string & name = "G");
+   /// Writes the edges as lines of source, destination and weight, separated by spaces.
+   /// This is the edge line format of the LowestPath data files.
+   /// Values are written as they are, so they should not contain spaces if the list is read back.
+   template <typename T>
+   static bool writeEdgeList(std::ostream & stream, const Graph<T> & graph, EdgeType type = EDirected);
+   /// Writes the edges as CSV with the header line "source,destination,weight".
+   template <typename T>
+   static bool writeCsv(std::ostream & stream, const Graph<T> & graph, EdgeType type = EDirected);
+   /// Writes the graph in the given format.
+   template <typename T>
+   static bool write(std::ostream & stream, const Graph<T> & graph, ExportFormat format, EdgeType type = EDirected);
+
+private:
+   // How a value is written: as it is, as a quoted DOT id or as a CSV field.
+   enum Quoting {ENoQuotes, EDotQuotes, ECsvQuotes};
+
+   /// Output buffer with formatting of the values, written to the stream in big chunks.
+   class Buffer {
+   public:
+      Buffer(std::ostream & stream);
+      ~Buffer();
+      void text(std::string_view text);
+      void character(char character);
+      void number(double value);
+      template <typename T>
+      void value(const T & data, Quoting quoting);
+      bool flush();
+   private:
+      void quoted(std::string_view text, Quoting quoting);
+      void reserve(std::size_t bytes);
+
+      std::ostream & stream;
+      std::vector<char> buffer;
+      std::size_t used;
+      std::ostringstream formatter;   // Reused for types without a fast path.
+   };
+
+   template <typename T>
+   static bool isWritten(const Edge<T> & edge, EdgeType type);
+   template <typename T>
+   static bool writeEdges(Buffer & buffer, const Graph<T> & graph, EdgeType type, Quoting quoting, char separator);
+};
+
+
+inline GraphExport::Buffer::Buffer(std::ostream & stream)
+: stream(stream), buffer(1 << 20), used(0) {
+}
+
+inline GraphExport::Buffer::~Buffer() {
+   flush();
+}
+
+inline void GraphExport::Buffer::reserve(std::size_t bytes) {
+   if (used + bytes > buffer.size()) {
+      flush();
+      if (bytes > buffer.size()) {
+         buffer.resize(bytes);
+      }
+   }
+}
+
+inline bool GraphExport::Buffer::flush() {
+   if (used > 0) {
+      stream.write(buffer.data(), used);
+      used = 0;
+   }
+   return static_cast<bool>(stream);
+}
+
+inline void GraphExport::Buffer::text(std::string_view text) {
+   reserve(text.size());
+   text.copy(buffer.data() + used, text.size());
+   used += text.size();
+}
+
+inline void GraphExport::Buffer::character(char character) {
+   reserve(1);
+   buffer[used++] = character;
+}
+
+/*
+ Shortest representation that reads back to the same double, so integer weights
+ are written without decimals.
+ */
+inline void GraphExport::Buffer::number(double value) {
+   reserve(32);
+   auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+   used = result.ptr - buffer.data();
+}
+
+/*
+ DOT ids are quoted, with their quotes and backslashes escaped and their line breaks
+ written as \n, so an id ending in a backslash does not escape the closing quote.
+ CSV fields are quoted only when they contain a separator, quote or line break, and
+ quotes are doubled. Each character takes at most two.
+ */
+inline void GraphExport::Buffer::quoted(std::string_view text, Quoting quoting) {
+   if (quoting == ENoQuotes || (quoting == ECsvQuotes && text.find_first_of(",\"\r\n") == std::string_view::npos)) {
+      this->text(text);
+      return;
+   }
+   reserve(2 * text.size() + 2);
+   buffer[used++] = '"';
+   for (char character : text) {
+      if (quoting == EDotQuotes && (character == '"' || character == '\\' || character == '\n')) {
+         buffer[used++] = '\\';
+         buffer[used++] = character == '\n' ? 'n' : character;
+         continue;
+      }
+      if (character == '"') {
+         buffer[used++] = '"';
+      }
+      buffer[used++] = character;
+   }
+   buffer[used++] = '"';
+}
+
+template <typename T>
+void GraphExport::Buffer::value(const T & data, Quoting quoting) {
+   if constexpr (std::is_integral_v<T>) {
+      reserve(24);
+      auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), data);
+      used = result.ptr - buffer.data();
+   } else if constexpr (std::is_floating_point_v<T>) {
+      number(data);
+   } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      quoted(std::string_view(data), quoting);
+   } else {
+      formatter.str(std::string());
+      formatter << data;
+      std::string formatted = formatter.str();
+      formatted.erase(formatted.find_last_not_of(" \t") + 1);
+      quoted(formatted, quoting);
+   }
+}
+
+template <typename T>
+bool GraphExport::isWritten(const Edge<T> & edge, EdgeType type) {
+   return type == EDirected || !(edge.destination < edge.source);
+}
+
+template <typename T>
+bool GraphExport::writeEdges(Buffer & buffer, const Graph<T> & graph, EdgeType type, Quoting quoting, char separator) {
+   for (const auto & [vertex, edges] : graph.adjacencies) {
+      for (const auto & edge : edges) {
+         if (isWritten(edge, type)) {
+            buffer.value(edge.source.data, quoting);
+            buffer.character(separator);
+            buffer.value(edge.destination.data, quoting);
+            buffer.character(separator);
+            buffer.number(edge.weight);
+            buffer.character('\n');
+         }
+      }
+   }
+   return buffer.flush();
+}
+
+/*
+ Vertices are listed first so that also the vertices without edges are drawn.
+ Weights are shown as edge labels.
+ */
+template <typename T>
+bool GraphExport::writeDot(std::ostream & stream, const Graph<T> & graph, EdgeType type, const std::string & name) {
+   Buffer buffer(stream);
+   const std::string_view arrow = type == EDirected ? " -> " : " -- ";
+   buffer.text(type == EDirected ? "digraph " : "graph ");
+   buffer.value(name, EDotQuotes);
+   buffer.text(" {\n");
+   for (const auto & [vertex, edges] : graph.adjacencies) {
+      buffer.text("  ");
+      buffer.value(vertex.data, EDotQuotes);
+      buffer.text(";\n");
+   }
+   for (const auto & [vertex, edges] : graph.adjacencies) {
+      for (const auto & edge : edges) {
+         if (isWritten(edge, type)) {
+            buffer.text("  ");
+            buffer.value(edge.source.data, EDotQuotes);
+            buffer.text(arrow);
+            buffer.value(edge.destination.data, EDotQuotes);
+            buffer.text(" [label=\"");
+            buffer.number(edge.weight);
+            buffer.text("\"];\n");
+         }
+      }
+   }
+   buffer.text("}\n");
+   return buffer.flush();
+}
+
+template <typename T>
+bool GraphExport::writeEdgeList(std::ostream & stream, const Graph<T> & graph, EdgeType type) {
+   Buffer buffer(stream);
+   return writeEdges(buffer, graph, type, ENoQuotes, ' ');
+}
+
+template <typename T>
+bool GraphExport::writeCsv(std::ostream & stream, const Graph<T> & graph, EdgeType type) {
+   Buffer buffer(stream);
+   buffer.text("source,destination,weight\n");
+   return writeEdges(buffer, graph, type, ECsvQuotes, ',');
+}
+
+template <typename T>
+bool GraphExport::write(std::ostream & stream, const Graph<T> & graph, ExportFormat format, EdgeType type) {
+   switch (format) {
+      case EDotFormat:
+         return writeDot(stream, graph, type);
+      case EEdgeListFormat:
+         return writeEdgeList(stream, graph, type);
+      case ECsvFormat:
+         return writeCsv(stream, graph, type);
+   }
+   return false;
+}
+
+#endif /* GraphExport_hpp */
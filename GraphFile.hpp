@@ -0,0 +1,205 @@
+#ifndef GraphFile_hpp
+#define GraphFile_hpp
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <charconv>  // to_chars, fast number formatting without locales
+
+#include "Graph.hpp"
+#include "GraphGenerator.hpp"
+
+/// Reads and writes graphs with integer vertices, like the LowestPath data files.
+///
+/// The text format is the LowestPath format: first line has the number of vertices
+/// and edges, then one line per edge with source, destination and the weight,
+/// and the last line has the target vertex.
+///
+/// The binary format holds the same information in native byte order:
+///  - 4 bytes "GRPH", uint32 format version (1), uint32 flags (bit 0 set if edges are directed)
+///  - int32 vertex count, int64 edge count, int32 target vertex
+///  - for each edge: int32 source, int32 destination, 64 bit double weight.
+/// Binary files are smaller and much faster to read than the text files.
+class GraphFile {
+public:
+   /// Writes the edges in the LowestPath text format. Weights are written as integers.
+   static bool writeText(std::ostream & stream, int vertexCount, const std::vector<GeneratedEdge> & edges, int target);
+   /// Writes the edges in the binary format.
+   static bool writeBinary(std::ostream & stream, int vertexCount, const std::vector<GeneratedEdge> & edges, int target, EdgeType type = EUndirected);
+
+   /// Checks if the stream starts with the binary format header. Does not consume anything.
+   static bool isBinary(std::istream & stream);
+   /// Reads a binary graph into the edge list. Returns false if the stream is not a valid binary graph.
+   static bool readBinary(std::istream & stream, int & vertexCount, std::vector<GeneratedEdge> & edges, int & target, EdgeType & type);
+   /// Reads a binary graph into the graph, using the threads to build it.
+   /// Returns false if the stream is not a valid binary graph.
+   static bool readBinary(std::istream & stream, Graph<int> & graph, int & target, int threads = 1);
+   /// Reads the header of a binary graph, leaving the stream at the first edge.
+   static bool readBinaryHeader(std::istream & stream, int & vertexCount, std::int64_t & edgeCount, int & target, EdgeType & type);
+   /// Reads the next count edges of a binary graph, appending them to the edges.
+   /// Lets large files be read in parts without having all the edges in memory.
+   static bool readBinaryEdges(std::istream & stream, std::size_t count, std::vector<GeneratedEdge> & edges);
+
+private:
+   static constexpr char magic[4] = {'G', 'R', 'P', 'H'};
+   static constexpr std::uint32_t formatVersion = 1;
+   static constexpr std::uint32_t directedFlag = 1;
+
+   template <typename Value>
+   static void put(std::ostream & stream, Value value);
+   template <typename Value>
+   static bool get(std::istream & stream, Value & value);
+};
+
+
+template <typename Value>
+void GraphFile::put(std::ostream & stream, Value value) {
+   stream.write(reinterpret_cast<const char *>(&value), sizeof(Value));
+}
+
+template <typename Value>
+bool GraphFile::get(std::istream & stream, Value & value) {
+   return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(Value)));
+}
+
+/*
+ Lines are formatted into a buffer with to_chars and the buffer written to the stream
+ when nearly full, so the stream is not flushed or called for every number.
+ */
+inline bool GraphFile::writeText(std::ostream & stream, int vertexCount, const std::vector<GeneratedEdge> & edges, int target) {
+   std::vector<char> buffer(1 << 20);
+   std::size_t used = 0;
+   auto number = [&buffer, &used](long long value, char separator) {
+      auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size() - 1, value);
+      used = result.ptr - buffer.data();
+      *result.ptr = separator;
+      used++;
+   };
+   number(vertexCount, ' ');
+   number(static_cast<long long>(edges.size()), '\n');
+   for (const auto & edge : edges) {
+      if (used + 64 > buffer.size()) {
+         stream.write(buffer.data(), used);
+         used = 0;
+      }
+      number(edge.source, ' ');
+      number(edge.destination, ' ');
+      number(static_cast<long long>(edge.weight), '\n');
+   }
+   number(target, '\n');
+   stream.write(buffer.data(), used);
+   return static_cast<bool>(stream);
+}
+
+inline bool GraphFile::writeBinary(std::ostream & stream, int vertexCount, const std::vector<GeneratedEdge> & edges, int target, EdgeType type) {
+   stream.write(magic, sizeof(magic));
+   put<std::uint32_t>(stream, formatVersion);
+   put<std::uint32_t>(stream, type == EDirected ? directedFlag : 0);
+   put<std::int32_t>(stream, vertexCount);
+   put<std::int64_t>(stream, static_cast<std::int64_t>(edges.size()));
+   put<std::int32_t>(stream, target);
+   // Edges are copied to a buffer as fixed size records and written in chunks.
+   const std::size_t recordSize = 2 * sizeof(std::int32_t) + sizeof(double);
+   std::vector<char> buffer(recordSize * 65536);
+   std::size_t used = 0;
+   for (const auto & edge : edges) {
+      std::int32_t source = edge.source;
+      std::int32_t destination = edge.destination;
+      std::memcpy(buffer.data() + used, &source, sizeof(source));
+      std::memcpy(buffer.data() + used + sizeof(source), &destination, sizeof(destination));
+      std::memcpy(buffer.data() + used + 2 * sizeof(source), &edge.weight, sizeof(edge.weight));
+      used += recordSize;
+      if (used == buffer.size()) {
+         stream.write(buffer.data(), used);
+         used = 0;
+      }
+   }
+   stream.write(buffer.data(), used);
+   return static_cast<bool>(stream);
+}
+
+inline bool GraphFile::isBinary(std::istream & stream) {
+   char header[sizeof(magic)] = {0};
+   auto position = stream.tellg();
+   stream.read(header, sizeof(header));
+   bool found = stream.gcount() == sizeof(header) && std::memcmp(header, magic, sizeof(magic)) == 0;
+   stream.clear();
+   stream.seekg(position);
+   return found;
+}
+
+inline bool GraphFile::readBinary(std::istream & stream, int & vertexCount, std::vector<GeneratedEdge> & edges, int & target, EdgeType & type) {
+   std::int64_t edgeCount = 0;
+   if (!readBinaryHeader(stream, vertexCount, edgeCount, target, type)) {
+      return false;
+   }
+   edges.clear();
+   edges.reserve(static_cast<std::size_t>(edgeCount));
+   std::int64_t remaining = edgeCount;
+   while (remaining > 0) {
+      std::size_t records = static_cast<std::size_t>(std::min<std::int64_t>(remaining, 65536));
+      if (!readBinaryEdges(stream, records, edges)) {
+         return false;
+      }
+      remaining -= records;
+   }
+   return true;
+}
+
+inline bool GraphFile::readBinaryHeader(std::istream & stream, int & vertexCount, std::int64_t & edgeCount, int & target, EdgeType & type) {
+   char header[sizeof(magic)];
+   std::uint32_t version = 0;
+   std::uint32_t flags = 0;
+   std::int32_t vertices = 0;
+   std::int64_t edgeTotal = 0;
+   std::int32_t targetVertex = 0;
+   if (!stream.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0 ||
+       !get(stream, version) || version != formatVersion ||
+       !get(stream, flags) || !get(stream, vertices) || !get(stream, edgeTotal) || !get(stream, targetVertex) ||
+       edgeTotal < 0) {
+      return false;
+   }
+   vertexCount = vertices;
+   edgeCount = edgeTotal;
+   target = targetVertex;
+   type = (flags & directedFlag) ? EDirected : EUndirected;
+   return true;
+}
+
+inline bool GraphFile::readBinaryEdges(std::istream & stream, std::size_t count, std::vector<GeneratedEdge> & edges) {
+   const std::size_t recordSize = 2 * sizeof(std::int32_t) + sizeof(double);
+   std::vector<char> buffer(recordSize * std::min<std::size_t>(count, 65536));
+   while (count > 0) {
+      std::size_t records = std::min<std::size_t>(count, 65536);
+      if (!stream.read(buffer.data(), records * recordSize)) {
+         return false;
+      }
+      for (std::size_t record = 0; record < records; record++) {
+         const char * data = buffer.data() + record * recordSize;
+         std::int32_t source = 0;
+         std::int32_t destination = 0;
+         double weight = 0.0;
+         std::memcpy(&source, data, sizeof(source));
+         std::memcpy(&destination, data + sizeof(source), sizeof(destination));
+         std::memcpy(&weight, data + 2 * sizeof(source), sizeof(weight));
+         edges.push_back({source, destination, weight});
+      }
+      count -= records;
+   }
+   return true;
+}
+
+inline bool GraphFile::readBinary(std::istream & stream, Graph<int> & graph, int & target, int threads) {
+   int vertexCount = 0;
+   std::vector<GeneratedEdge> edges;
+   EdgeType type = EUndirected;
+   if (!readBinary(stream, vertexCount, edges, target, type)) {
+      return false;
+   }
+   GraphGenerator::fill(graph, vertexCount, edges, type, threads);
+   return true;
+}
+
+#endif /* GraphFile_hpp */
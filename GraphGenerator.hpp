@@ -0,0 +1,344 @@
+#ifndef GraphGenerator_hpp
+#define GraphGenerator_hpp
+
+#include <vector>    // generated edge lists
+#include <random>    // reproducible random numbers from a seed
+#include <string>
+#include <cmath>
+#include <algorithm> // sorting and removing repeated edges
+#include <utility>
+
+#include "Graph.hpp"
+
+/// An edge of a generated graph. Vertices are numbered from 1 to the number of vertices,
+/// like the cities in the LowestPath data files.
+struct GeneratedEdge {
+   int source;
+   int destination;
+   double weight;
+};
+
+/// How the weights of the generated edges are distributed between 1 and the max weight.
+/// Weights are whole numbers, since the LowestPath files have integer weights.
+enum WeightDistribution {
+   EUniformWeights,       // All weights equally likely
+   EExponentialWeights,   // Mostly light edges, a few heavy ones
+   ENormalWeights         // Most weights around the half of the max weight
+};
+
+/// Generates synthetic graphs as edge lists, for benchmarking and load testing.
+/// Same seed always gives the same graph.
+class GraphGenerator {
+public:
+   /// Creates a generator using the seed, giving edge weights between 1 and maxWeight.
+   GraphGenerator(unsigned long seed = 1, int maxWeight = 100, WeightDistribution distribution = EUniformWeights);
+
+   /// A width x height grid, each cell connected to the cells right and below it.
+   std::vector<GeneratedEdge> grid(int width, int height);
+   /// A width x height grid of cells with smoothly varying heights, like terrain. Each cell is
+   /// connected to the cells right and below it, weight being the height of the higher cell.
+   std::vector<GeneratedEdge> heightMap(int width, int height);
+   /// Random sparse graph (Erdős–Rényi G(n, m)), edgeCount edges between random vertex pairs.
+   std::vector<GeneratedEdge> randomSparse(int vertexCount, long edgeCount);
+   /// Power-law graph using recursive matrix (R-MAT) model with 2^scale vertices.
+   std::vector<GeneratedEdge> powerLaw(int scale, long edgeCount);
+   /// Road network like graph: random points on a plane, each connected to its nearest
+   /// neighbours. Weight is the distance between the points, scaled to 1...max weight.
+   std::vector<GeneratedEdge> road(int vertexCount, int neighbours = 3);
+
+   /// Adds edges between the disconnected parts of the graph, so that all vertices
+   /// 1...vertexCount can be reached from each other. Returns the number of edges added.
+   long connect(int vertexCount, std::vector<GeneratedEdge> & edges);
+
+   /// Fills the graph with vertices 1...vertexCount and the edges, replacing what was in it.
+   /// The threads are used to sort the edges.
+   static void fill(Graph<int> & graph, int vertexCount, const std::vector<GeneratedEdge> & edges, EdgeType type, int threads = 1);
+
+private:
+   /// Gives a weight for the next edge.
+   double nextWeight();
+
+   std::mt19937_64 random;
+   int maxWeight;
+   WeightDistribution distribution;
+};
+
+
+inline GraphGenerator::GraphGenerator(unsigned long seed, int maxWeight, WeightDistribution distribution)
+: random(seed), maxWeight(std::max(1, maxWeight)), distribution(distribution) {
+}
+
+inline double GraphGenerator::nextWeight() {
+   double weight = 1.0;
+   switch (distribution) {
+      case EUniformWeights:
+         return static_cast<double>(std::uniform_int_distribution<int>(1, maxWeight)(random));
+      case EExponentialWeights:
+         weight = std::exponential_distribution<double>(4.0 / maxWeight)(random);
+         break;
+      case ENormalWeights:
+         weight = std::normal_distribution<double>(maxWeight / 2.0, maxWeight / 6.0)(random);
+         break;
+   }
+   return std::clamp(std::round(weight), 1.0, static_cast<double>(maxWeight));
+}
+
+/*
+ Cells are numbered row by row. Edges go right and down, so when the edges are
+ directed the grid has no cycles.
+ */
+inline std::vector<GeneratedEdge> GraphGenerator::grid(int width, int height) {
+   std::vector<GeneratedEdge> edges;
+   edges.reserve(2L * width * height);
+   for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+         int cell = y * width + x + 1;
+         if (x + 1 < width) {
+            edges.push_back({cell, cell + 1, nextWeight()});
+         }
+         if (y + 1 < height) {
+            edges.push_back({cell, cell + width, nextWeight()});
+         }
+      }
+   }
+   return edges;
+}
+
+/*
+ Heights are value noise: random heights on a coarse lattice, interpolated smoothly
+ between the lattice points, plus a little random variation per cell. The result has
+ hills and valleys, so there are lower routes around the high areas, as in the
+ LowestPath problem. Weight distribution is not used here.
+ */
+inline std::vector<GeneratedEdge> GraphGenerator::heightMap(int width, int height) {
+   const int spacing = 16;   // Cells between the lattice points.
+   int latticeWidth = width / spacing + 2;
+   int latticeHeight = height / spacing + 2;
+   std::uniform_real_distribution<double> unit(0.0, 1.0);
+   std::vector<double> lattice(static_cast<std::size_t>(latticeWidth) * latticeHeight);
+   for (auto & point : lattice) {
+      point = unit(random);
+   }
+   auto smooth = [](double t) { return t * t * (3.0 - 2.0 * t); };
+   std::vector<double> heights(static_cast<std::size_t>(width) * height);
+   for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+         int lx = x / spacing;
+         int ly = y / spacing;
+         double tx = smooth(static_cast<double>(x % spacing) / spacing);
+         double ty = smooth(static_cast<double>(y % spacing) / spacing);
+         double top = lattice[ly * latticeWidth + lx] * (1.0 - tx) + lattice[ly * latticeWidth + lx + 1] * tx;
+         double bottom = lattice[(ly + 1) * latticeWidth + lx] * (1.0 - tx) + lattice[(ly + 1) * latticeWidth + lx + 1] * tx;
+         double value = 0.85 * (top * (1.0 - ty) + bottom * ty) + 0.15 * unit(random);
+         heights[static_cast<std::size_t>(y) * width + x] = 1.0 + std::round(value * (maxWeight - 1));
+      }
+   }
+   std::vector<GeneratedEdge> edges;
+   edges.reserve(2L * width * height);
+   for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+         std::size_t cell = static_cast<std::size_t>(y) * width + x;
+         if (x + 1 < width) {
+            edges.push_back({static_cast<int>(cell) + 1, static_cast<int>(cell) + 2, std::max(heights[cell], heights[cell + 1])});
+         }
+         if (y + 1 < height) {
+            edges.push_back({static_cast<int>(cell) + 1, static_cast<int>(cell + width) + 1, std::max(heights[cell], heights[cell + width])});
+         }
+      }
+   }
+   return edges;
+}
+
+/*
+ Picks random vertex pairs, skipping self loops. Some pairs may repeat;
+ Graph ignores the repeated edges when the edges are added.
+ */
+inline std::vector<GeneratedEdge> GraphGenerator::randomSparse(int vertexCount, long edgeCount) {
+   std::vector<GeneratedEdge> edges;
+   if (vertexCount < 2) {
+      return edges;
+   }
+   edges.reserve(edgeCount);
+   std::uniform_int_distribution<int> vertex(1, vertexCount);
+   while (static_cast<long>(edges.size()) < edgeCount) {
+      int source = vertex(random);
+      int destination = vertex(random);
+      if (source != destination) {
+         edges.push_back({source, destination, nextWeight()});
+      }
+   }
+   return edges;
+}
+
+/*
+ R-MAT picks each edge by recursively dividing the adjacency matrix into four
+ quadrants and choosing one with probabilities a, b, c and d. Skewed probabilities
+ give a few vertices very many edges, like hubs in real networks.
+ */
+inline std::vector<GeneratedEdge> GraphGenerator::powerLaw(int scale, long edgeCount) {
+   const double a = 0.57;
+   const double b = 0.19;
+   const double c = 0.19;
+   std::vector<GeneratedEdge> edges;
+   if (scale < 1) {
+      return edges;
+   }
+   edges.reserve(edgeCount);
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+   while (static_cast<long>(edges.size()) < edgeCount) {
+      int source = 0;
+      int destination = 0;
+      for (int bit = 0; bit < scale; bit++) {
+         double p = probability(random);
+         if (p < a) {
+            // Top left quadrant, neither bit set.
+         } else if (p < a + b) {
+            destination |= 1 << bit;
+         } else if (p < a + b + c) {
+            source |= 1 << bit;
+         } else {
+            source |= 1 << bit;
+            destination |= 1 << bit;
+         }
+      }
+      if (source != destination) {
+         edges.push_back({source + 1, destination + 1, nextWeight()});
+      }
+   }
+   return edges;
+}
+
+/*
+ Points are put into square buckets holding about one point each, so the nearest
+ neighbours are found by looking at the buckets around the point, growing the
+ searched area until enough neighbours are found. Each pair is connected once.
+ */
+inline std::vector<GeneratedEdge> GraphGenerator::road(int vertexCount, int neighbours) {
+   std::vector<GeneratedEdge> edges;
+   if (vertexCount < 2) {
+      return edges;
+   }
+   neighbours = std::clamp(neighbours, 1, vertexCount - 1);
+   std::uniform_real_distribution<double> unit(0.0, 1.0);
+   std::vector<double> xs(vertexCount);
+   std::vector<double> ys(vertexCount);
+   for (int point = 0; point < vertexCount; point++) {
+      xs[point] = unit(random);
+      ys[point] = unit(random);
+   }
+   int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(vertexCount))));
+   auto bucketOf = [side](double coordinate) { return std::min(side - 1, static_cast<int>(coordinate * side)); };
+   // Points sorted by bucket, bucketStart[b] being the first point of bucket b.
+   std::vector<int> bucketStart(static_cast<std::size_t>(side) * side + 1, 0);
+   std::vector<int> points(vertexCount);
+   for (int point = 0; point < vertexCount; point++) {
+      bucketStart[bucketOf(ys[point]) * side + bucketOf(xs[point]) + 1]++;
+   }
+   for (std::size_t bucket = 1; bucket < bucketStart.size(); bucket++) {
+      bucketStart[bucket] += bucketStart[bucket - 1];
+   }
+   std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+   for (int point = 0; point < vertexCount; point++) {
+      points[fill[bucketOf(ys[point]) * side + bucketOf(xs[point])]++] = point;
+   }
+
+   std::vector<std::pair<int, int>> pairs;
+   pairs.reserve(static_cast<std::size_t>(vertexCount) * neighbours);
+   std::vector<std::pair<double, int>> candidates;
+   for (int point = 0; point < vertexCount; point++) {
+      int bx = bucketOf(xs[point]);
+      int by = bucketOf(ys[point]);
+      // Grow the ring of searched buckets until there are enough candidates, then one more
+      // ring, since a nearer point may be in the next ring.
+      int radius = 0;
+      bool enough = false;
+      candidates.clear();
+      while (radius <= side) {
+         for (int y = by - radius; y <= by + radius; y++) {
+            for (int x = bx - radius; x <= bx + radius; x++) {
+               bool onRing = std::abs(y - by) == radius || std::abs(x - bx) == radius;
+               if (!onRing || x < 0 || y < 0 || x >= side || y >= side) {
+                  continue;
+               }
+               for (int index = bucketStart[y * side + x]; index < bucketStart[y * side + x + 1]; index++) {
+                  int other = points[index];
+                  if (other != point) {
+                     double dx = xs[other] - xs[point];
+                     double dy = ys[other] - ys[point];
+                     candidates.push_back({dx * dx + dy * dy, other});
+                  }
+               }
+            }
+         }
+         radius++;
+         if (enough) {
+            break;
+         }
+         enough = static_cast<int>(candidates.size()) >= neighbours;
+      }
+      std::partial_sort(candidates.begin(), candidates.begin() + neighbours, candidates.end());
+      for (int neighbour = 0; neighbour < neighbours; neighbour++) {
+         int other = candidates[neighbour].second;
+         pairs.push_back({std::min(point, other), std::max(point, other)});
+      }
+   }
+   std::sort(pairs.begin(), pairs.end());
+   pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+   // Typical neighbour distance is about one bucket; that is mapped to the half of the max weight.
+   double scale = side * maxWeight / 2.0;
+   edges.reserve(pairs.size());
+   for (const auto & [source, destination] : pairs) {
+      double distance = std::hypot(xs[source] - xs[destination], ys[source] - ys[destination]);
+      edges.push_back({source + 1, destination + 1, std::clamp(std::round(distance * scale), 1.0, static_cast<double>(maxWeight))});
+   }
+   return edges;
+}
+
+/*
+ Finds the connected parts using union-find and links each part to a random vertex
+ in the parts already connected to vertex 1.
+ */
+inline long GraphGenerator::connect(int vertexCount, std::vector<GeneratedEdge> & edges) {
+   std::vector<int> parent(vertexCount + 1);
+   for (int vertex = 0; vertex <= vertexCount; vertex++) {
+      parent[vertex] = vertex;
+   }
+   auto root = [&parent](int vertex) {
+      while (parent[vertex] != vertex) {
+         parent[vertex] = parent[parent[vertex]];   // Halve the path while going up.
+         vertex = parent[vertex];
+      }
+      return vertex;
+   };
+   for (const auto & edge : edges) {
+      parent[root(edge.source)] = root(edge.destination);
+   }
+   long added = 0;
+   for (int vertex = 2; vertex <= vertexCount; vertex++) {
+      if (root(vertex) != root(1)) {
+         int other = std::uniform_int_distribution<int>(1, vertex - 1)(random);
+         edges.push_back({other, vertex, nextWeight()});
+         parent[root(vertex)] = root(other);
+         added++;
+      }
+   }
+   return added;
+}
+
+inline void GraphGenerator::fill(Graph<int> & graph, int vertexCount, const std::vector<GeneratedEdge> & edges, EdgeType type, int threads) {
+   std::vector<Edge<int>> graphEdges;
+   graphEdges.reserve(edges.size());
+   for (const auto & edge : edges) {
+      graphEdges.emplace_back(Vertex<int>(edge.source), Vertex<int>(edge.destination), edge.weight);
+   }
+   graph.buildFrom(graphEdges, type, threads);
+   // Vertices without any edges are not in the edges.
+   if (graph.adjacencies.size() < static_cast<std::size_t>(vertexCount)) {
+      for (int vertex = 1; vertex <= vertexCount; vertex++) {
+         graph.createVertex(vertex);
+      }
+   }
+}
+
+#endif /* GraphGenerator_hpp */
@@ -0,0 +1,148 @@
+#ifndef GraphView_hpp
+#define GraphView_hpp
+
+#include <functional>
+#include <vector>
+#include <queue>
+#include <stack>
+#include <set>
+
+#include "Graph.hpp"
+
+/// A filtered view of a graph, without copying it. The view includes the vertices
+/// accepted by the vertex filter and the edges accepted by the edge filter whose both
+/// ends are included. Without filters, the view is the whole graph.
+///
+/// Dijkstra and Prim can be given a view instead of a graph, and breadth and depth first
+/// searches can be done on the view. The filters are called during the algorithms, so they
+/// should be fast. Filters of edges see the source and destination vertices stored in the
+/// edge, so those should hold the same data as the vertices of the graph.
+///
+/// The view refers to the graph, so the graph must exist as long as the view is used.
+template <typename T>
+class GraphView {
+public:
+   typedef std::function<bool(const Vertex<T> &)> VertexFilter;
+   typedef std::function<bool(const Edge<T> &)> EdgeFilter;
+
+   /// Creates a view to the graph. A missing (empty) filter includes everything.
+   GraphView(const Graph<T> & graph, VertexFilter vertexFilter = VertexFilter(), EdgeFilter edgeFilter = EdgeFilter());
+
+   /// Does the view filter anything out.
+   bool isFiltered() const;
+   /// Is the vertex in the view.
+   bool includes(const Vertex<T> & vertex) const;
+   /// Is the edge in the view, including both of its ends.
+   bool includes(const Edge<T> & edge) const;
+
+   /// Gets all the vertices of the view.
+   std::vector<Vertex<T>> allVertices() const;
+   /// Does a breadth first search from vertex through the view. Empty if from is not in the view.
+   std::vector<Vertex<T>> breadthFirstSearchFrom(const Vertex<T> & from) const;
+   /// Does a depth first search from vertex through the view. Empty if from is not in the view.
+   std::vector<Vertex<T>> depthFirstSearchFrom(const Vertex<T> & from) const;
+
+   /// The graph viewed.
+   const Graph<T> & graph;
+
+private:
+   VertexFilter vertexFilter;
+   EdgeFilter edgeFilter;
+};
+
+
+template <typename T>
+GraphView<T>::GraphView(const Graph<T> & graph, VertexFilter vertexFilter, EdgeFilter edgeFilter)
+: graph(graph), vertexFilter(vertexFilter), edgeFilter(edgeFilter) {
+}
+
+template <typename T>
+bool GraphView<T>::isFiltered() const {
+   return vertexFilter || edgeFilter;
+}
+
+template <typename T>
+bool GraphView<T>::includes(const Vertex<T> & vertex) const {
+   return !vertexFilter || vertexFilter(vertex);
+}
+
+template <typename T>
+bool GraphView<T>::includes(const Edge<T> & edge) const {
+   return (!edgeFilter || edgeFilter(edge)) && includes(edge.source) && includes(edge.destination);
+}
+
+template <typename T>
+std::vector<Vertex<T>> GraphView<T>::allVertices() const {
+   std::vector<Vertex<T>> vertices;
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      if (includes(vertexAndEdges.first)) {
+         vertices.push_back(vertexAndEdges.first);
+      }
+   }
+   return vertices;
+}
+
+/*
+ Same as Graph::breadthFirstSearchFrom, leaving out what is not in the view.
+ */
+template <typename T>
+std::vector<Vertex<T>> GraphView<T>::breadthFirstSearchFrom(const Vertex<T> & from) const {
+   GRAPH_TRACE_SPAN("GraphView::breadthFirstSearchFrom");
+   std::queue<Vertex<T>> queue;
+   std::set<Vertex<T>> enqueued;
+   std::vector<Vertex<T>> visited;
+   auto start = graph.adjacencies.find(from);
+   if (start == graph.adjacencies.end() || !includes(start->first)) {
+      return visited;
+   }
+   queue.push(from);
+   enqueued.insert(from);
+   while (!queue.empty()) {
+      auto vertex = queue.front();
+      queue.pop();
+      visited.push_back(graph.adjacencies.find(vertex)->first);
+      for (const auto & edge : graph.edges(vertex)) {
+         if (includes(edge) && enqueued.find(edge.destination) == enqueued.end()) {
+            queue.push(edge.destination);
+            enqueued.insert(edge.destination);
+         }
+      }
+   }
+   return visited;
+}
+
+/*
+ Same as Graph::depthFirstSearchFrom, leaving out what is not in the view.
+ */
+template <typename T>
+std::vector<Vertex<T>> GraphView<T>::depthFirstSearchFrom(const Vertex<T> & from) const {
+   GRAPH_TRACE_SPAN("GraphView::depthFirstSearchFrom");
+   std::stack<Vertex<T>> stack;
+   std::set<Vertex<T>> pushed;
+   std::vector<Vertex<T>> visited;
+   auto start = graph.adjacencies.find(from);
+   if (start == graph.adjacencies.end() || !includes(start->first)) {
+      return visited;
+   }
+   stack.push(from);
+   pushed.insert(from);
+   visited.push_back(start->first);
+   while (!stack.empty()) {
+      bool wentDeeper = false;
+      for (const auto & edge : graph.edges(stack.top())) {
+         if (includes(edge) && pushed.find(edge.destination) == pushed.end()) {
+            stack.push(edge.destination);
+            pushed.insert(edge.destination);
+            visited.push_back(graph.adjacencies.find(edge.destination)->first);
+            wentDeeper = true;
+            break;
+         }
+      }
+      if (!wentDeeper) {
+         stack.pop();
+      }
+   }
+   return visited;
+}
+
+#endif /* GraphView_hpp */
@@ -0,0 +1,199 @@
+#ifndef IncomingEdges_hpp
+#define IncomingEdges_hpp
+
+#include <map>       // incoming edges of each vertex
+#include <vector>    // arrays
+#include <algorithm> // std::find_if
+#include <mutex>     // index may be built from several threads reading the same graph
+
+#include "Vertex.hpp"
+#include "Edge.hpp"
+
+/// Index of the edges coming into each vertex of a graph, the reverse of the adjacencies.
+/// Graph owns an index. The index knows the graph version it matches, and is built again
+/// from the adjacencies when asked for with another version. When maintained, Graph applies
+/// the added and removed vertices and edges to the index as it changes, so changing the graph
+/// does not make the index out of date and it need not be built again. Removals are applied
+/// to a built index also when it is not maintained, since they only make it smaller, so that
+/// removing vertices one after another builds the index only once.
+template <typename T>
+class IncomingEdges {
+public:
+   /// The incoming edges of each vertex. Edges are the same as in the adjacencies,
+   /// so the source of the edge is the vertex the edge comes from.
+   typedef std::map<Vertex<T>, std::vector<Edge<T>>> Index;
+
+   IncomingEdges();
+   /// Copying an index copies whether it is maintained, not the index.
+   IncomingEdges(const IncomingEdges<T> & another);
+   const IncomingEdges<T> & operator = (const IncomingEdges<T> & another);
+
+   /// Gets the index matching the adjacencies of the given graph version, building it if needed.
+   const Index & of(const std::map<Vertex<T>, std::vector<Edge<T>>> & adjacencies, unsigned long version) const;
+
+   /// Sets whether the changes of the graph are applied to the index. Not maintaining drops the index.
+   void setMaintained(bool maintain);
+   /// Are the changes of the graph applied to the index.
+   bool isMaintained() const;
+
+   /// The vertex was added to the graph, changing the version from previous to version.
+   void vertexAdded(const Vertex<T> & vertex, unsigned long previous, unsigned long version);
+   /// The edge was added to the graph, changing the version from previous to version.
+   void edgeAdded(const Edge<T> & edge, unsigned long previous, unsigned long version);
+   /// The vertex was removed from the graph, after its edges were removed. Applied also when not maintained.
+   void vertexRemoved(const Vertex<T> & vertex, unsigned long previous, unsigned long version);
+   /// The edge was removed from the graph. Applied also when not maintained.
+   void edgeRemoved(const Edge<T> & edge, unsigned long previous, unsigned long version);
+   /// The weight of the edge was changed in the graph.
+   void weightUpdated(const Edge<T> & edge, unsigned long previous, unsigned long version);
+   /// Releases the memory left unused by removals.
+   void compact();
+
+private:
+   /// Is the index built for the version. Caller holds the mutex.
+   bool isBuiltFor(unsigned long version) const;
+
+   mutable Index index;
+   /// The graph version the index matches.
+   mutable unsigned long indexedVersion;
+   mutable bool built;
+   bool maintained;
+   mutable std::mutex mutex;
+};
+
+
+template <typename T>
+IncomingEdges<T>::IncomingEdges()
+: indexedVersion(0), built(false), maintained(false) {
+}
+
+template <typename T>
+IncomingEdges<T>::IncomingEdges(const IncomingEdges<T> & another)
+: indexedVersion(0), built(false), maintained(another.isMaintained()) {
+}
+
+template <typename T>
+const IncomingEdges<T> & IncomingEdges<T>::operator = (const IncomingEdges<T> & another) {
+   if (this != &another) {
+      bool maintain = another.isMaintained();
+      std::lock_guard<std::mutex> guard(mutex);
+      index.clear();
+      built = false;
+      maintained = maintain;
+   }
+   return *this;
+}
+
+/*
+ Builds the index by going through the edges of all the vertices once,
+ unless the index already matches the version.
+ */
+template <typename T>
+const typename IncomingEdges<T>::Index & IncomingEdges<T>::of(const std::map<Vertex<T>, std::vector<Edge<T>>> & adjacencies, unsigned long version) const {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (!isBuiltFor(version)) {
+      index.clear();
+      for (const auto & vertexAndEdges : adjacencies) {
+         index.emplace_hint(index.end(), vertexAndEdges.first, std::vector<Edge<T>>());
+      }
+      for (const auto & vertexAndEdges : adjacencies) {
+         for (const auto & edge : vertexAndEdges.second) {
+            index[edge.destination].push_back(edge);
+         }
+      }
+      indexedVersion = version;
+      built = true;
+   }
+   return index;
+}
+
+template <typename T>
+void IncomingEdges<T>::setMaintained(bool maintain) {
+   std::lock_guard<std::mutex> guard(mutex);
+   maintained = maintain;
+   if (!maintained) {
+      index.clear();
+      built = false;
+   }
+}
+
+template <typename T>
+bool IncomingEdges<T>::isMaintained() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return maintained;
+}
+
+/*
+ The change is applied only if the index matched the graph before it,
+ otherwise the index is out of date anyway and is built again when needed.
+ */
+template <typename T>
+void IncomingEdges<T>::vertexAdded(const Vertex<T> & vertex, unsigned long previous, unsigned long version) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (maintained && isBuiltFor(previous)) {
+      index.emplace(vertex, std::vector<Edge<T>>());
+      indexedVersion = version;
+   }
+}
+
+template <typename T>
+void IncomingEdges<T>::edgeAdded(const Edge<T> & edge, unsigned long previous, unsigned long version) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (maintained && isBuiltFor(previous)) {
+      index[edge.destination].push_back(edge);
+      indexedVersion = version;
+   }
+}
+
+template <typename T>
+void IncomingEdges<T>::vertexRemoved(const Vertex<T> & vertex, unsigned long previous, unsigned long version) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (isBuiltFor(previous)) {
+      index.erase(vertex);
+      indexedVersion = version;
+   }
+}
+
+template <typename T>
+void IncomingEdges<T>::edgeRemoved(const Edge<T> & edge, unsigned long previous, unsigned long version) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (isBuiltFor(previous)) {
+      auto & edges = index[edge.destination];
+      auto position = std::find_if(edges.begin(), edges.end(), [&edge](const Edge<T> & another) {
+         return another.source == edge.source;
+      });
+      if (position != edges.end()) {
+         edges.erase(position);
+      }
+      indexedVersion = version;
+   }
+}
+
+template <typename T>
+void IncomingEdges<T>::weightUpdated(const Edge<T> & edge, unsigned long previous, unsigned long version) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (maintained && isBuiltFor(previous)) {
+      for (auto & another : index[edge.destination]) {
+         if (another.source == edge.source) {
+            another.weight = edge.weight;
+            break;
+         }
+      }
+      indexedVersion = version;
+   }
+}
+
+template <typename T>
+void IncomingEdges<T>::compact() {
+   std::lock_guard<std::mutex> guard(mutex);
+   for (auto & vertexAndEdges : index) {
+      vertexAndEdges.second.shrink_to_fit();
+   }
+}
+
+template <typename T>
+bool IncomingEdges<T>::isBuiltFor(unsigned long version) const {
+   return built && indexedVersion == version;
+}
+
+#endif /* IncomingEdges_hpp */
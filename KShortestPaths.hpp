@@ -0,0 +1,380 @@
+#ifndef KShortestPaths_hpp
+#define KShortestPaths_hpp
+
+#include <vector>
+#include <set>
+#include <queue>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include "Graph.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// A path found by KShortestPaths: the edges from the source to the target, in that order,
+/// and the sum of their weights.
+template <typename T>
+struct RankedPath {
+   double length;
+   std::vector<Edge<T>> edges;
+};
+
+/**
+ Finds the k shortest loopless paths between two vertices with Yen's algorithm,
+ for giving alternatives to the one route Dijkstra finds.
+
+ Yen's algorithm takes each found path in turn, and for each vertex on it (the spur vertex)
+ searches the shortest path to the target that leaves the spur vertex by an edge not used
+ by the earlier found paths with the same beginning (the root), and does not go through the
+ vertices of the root. The best of these candidates is the next path.
+
+ To keep the spur searches fast:
+  - The graph is copied once to arrays indexed by vertex numbers, and the arrays used by the
+    searches are reused between the searches, so a spur search does not allocate. Vertices
+    and edges are blocked by marking them with the number of the search, so nothing needs
+    to be cleared between the searches.
+  - The distances from each vertex to the target in the whole graph are searched once per
+    target. Blocking only makes paths longer, so these are lower bounds of the spur paths,
+    and the spur searches use them as the A* heuristic to go straight towards the target.
+  - Only the k - found best candidates are kept. A spur search is skipped, or stopped early,
+    when its lower bound shows it cannot beat the worst of those.
+
+ The arrays are rebuilt if the graph has changed since the last search.
+ An object of the class should be used by one thread at a time.
+ */
+template <typename T>
+class KShortestPaths {
+public:
+   KShortestPaths(const Graph<T> & graph);
+
+   // Gives at most k shortest loopless paths from source to target, the shortest first.
+   // Empty if target cannot be reached from source. Weights must not be negative.
+   std::vector<RankedPath<T>> kShortestPaths(const Vertex<T> & source, const Vertex<T> & target, int k);
+   // Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   std::vector<RankedPath<T>> kShortestPaths(const Vertex<T> & source, const Vertex<T> & target, int k, AlgorithmStats & stats);
+
+   // The graph to search the paths from.
+   const Graph<T> & graph;
+
+private:
+   // Distance (or estimate) and the index of the vertex, in the search queues.
+   typedef std::pair<double, int> QueueElement;
+   // A path as edge numbers, with its length. Ordered by length, then by the edges.
+   typedef std::pair<double, std::vector<int>> IndexedPath;
+
+   // Copies the graph to the arrays, if it has changed since the last time.
+   void prepare();
+   // Searches the distances from all vertices to the target, if not already done.
+   void searchDistancesTo(int target, AlgorithmStats * stats);
+   // Searches the shortest path from spur to target avoiding the blocked vertices and edges.
+   // Gives up when the length would be bound or more. Puts the edges to spurEdges.
+   double spurSearch(int spur, int target, double bound, std::vector<int> & spurEdges, AlgorithmStats * stats);
+   // Starts a new spur search, so that older marks are no longer valid.
+   void nextStamp();
+   // Does the work of the public functions.
+   std::vector<RankedPath<T>> search(const Vertex<T> & source, const Vertex<T> & target, int k, AlgorithmStats * stats);
+   int indexOf(const Vertex<T> & vertex) const;
+
+   bool prepared = false;
+   unsigned long preparedVersion = 0;
+   std::vector<Vertex<T>> vertices;       // Vertices in graph order, index is the vertex number.
+   std::vector<int> offsets;              // Edges of vertex v are numbered offsets[v]...offsets[v+1]-1.
+   std::vector<int> sources;              // Source vertex of each edge.
+   std::vector<int> targets;              // Destination vertex of each edge.
+   std::vector<double> weights;           // Weight of each edge.
+   std::vector<int> incomingOffsets;      // Incoming edges of vertex v are incoming[incomingOffsets[v]...].
+   std::vector<int> incoming;
+
+   int boundsTarget = -1;                 // The target toTarget and nextEdge were searched for.
+   std::vector<double> toTarget;          // Shortest distance from each vertex to the target.
+   std::vector<int> nextEdge;             // First edge on the shortest path from vertex to target.
+
+   // Reused by the spur searches.
+   unsigned stamp = 0;
+   std::vector<unsigned> reached;         // == stamp if distance is set in this search.
+   std::vector<unsigned> settled;         // == stamp if vertex is already handled in this search.
+   std::vector<unsigned> blockedVertex;   // == stamp if vertex may not be used in this search.
+   std::vector<unsigned> blockedEdge;     // == stamp if edge may not be used in this search.
+   std::vector<double> distances;
+   std::vector<int> parentEdge;
+   std::vector<QueueElement> heap;
+};
+
+
+template <typename T>
+KShortestPaths<T>::KShortestPaths(const Graph<T> & graph)
+: graph(graph) {
+}
+
+template <typename T>
+std::vector<RankedPath<T>> KShortestPaths<T>::kShortestPaths(const Vertex<T> & source, const Vertex<T> & target, int k) {
+   return search(source, target, k, nullptr);
+}
+
+template <typename T>
+std::vector<RankedPath<T>> KShortestPaths<T>::kShortestPaths(const Vertex<T> & source, const Vertex<T> & target, int k, AlgorithmStats & stats) {
+   return search(source, target, k, &stats);
+}
+
+template <typename T>
+int KShortestPaths<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - vertices.begin());
+}
+
+/*
+ Edges are numbered in the order of the adjacency lists. Edges to vertices missing from
+ the graph are left out. Incoming edges are collected with a counting sort.
+ */
+template <typename T>
+void KShortestPaths<T>::prepare() {
+   if (prepared && preparedVersion == graph.version()) {
+      return;
+   }
+   vertices.clear();
+   vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+   }
+   const int vertexCount = static_cast<int>(vertices.size());
+   offsets.assign(1, 0);
+   sources.clear();
+   targets.clear();
+   weights.clear();
+   int source = 0;
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = indexOf(edge.destination);
+         if (destination >= 0) {
+            sources.push_back(source);
+            targets.push_back(destination);
+            weights.push_back(edge.weight);
+         }
+      }
+      offsets.push_back(static_cast<int>(targets.size()));
+      source++;
+   }
+   incomingOffsets.assign(vertexCount + 1, 0);
+   for (int destination : targets) {
+      incomingOffsets[destination + 1]++;
+   }
+   for (int vertex = 0; vertex < vertexCount; vertex++) {
+      incomingOffsets[vertex + 1] += incomingOffsets[vertex];
+   }
+   incoming.resize(targets.size());
+   std::vector<int> filled(incomingOffsets.begin(), incomingOffsets.end() - 1);
+   for (int edge = 0; edge < static_cast<int>(targets.size()); edge++) {
+      incoming[filled[targets[edge]]++] = edge;
+   }
+   reached.assign(vertexCount, 0);
+   settled.assign(vertexCount, 0);
+   blockedVertex.assign(vertexCount, 0);
+   blockedEdge.assign(targets.size(), 0);
+   distances.assign(vertexCount, 0.0);
+   parentEdge.assign(vertexCount, -1);
+   stamp = 0;
+   boundsTarget = -1;
+   preparedVersion = graph.version();
+   prepared = true;
+}
+
+template <typename T>
+void KShortestPaths<T>::nextStamp() {
+   if (++stamp == 0) {
+      // Wrapped around, old marks could look current.
+      std::fill(reached.begin(), reached.end(), 0);
+      std::fill(settled.begin(), settled.end(), 0);
+      std::fill(blockedVertex.begin(), blockedVertex.end(), 0);
+      std::fill(blockedEdge.begin(), blockedEdge.end(), 0);
+      stamp = 1;
+   }
+}
+
+/*
+ Dijkstra from the target along the incoming edges.
+ */
+template <typename T>
+void KShortestPaths<T>::searchDistancesTo(int target, [[maybe_unused]] AlgorithmStats * stats) {
+   if (boundsTarget == target) {
+      return;
+   }
+   const double infinity = std::numeric_limits<double>::infinity();
+   toTarget.assign(vertices.size(), infinity);
+   nextEdge.assign(vertices.size(), -1);
+   nextStamp();
+   heap.clear();
+   toTarget[target] = 0.0;
+   heap.push_back(QueueElement(0.0, target));
+   while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<QueueElement>());
+      auto [distance, vertex] = heap.back();
+      heap.pop_back();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[vertex] == stamp) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      settled[vertex] = stamp;
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (int position = incomingOffsets[vertex]; position < incomingOffsets[vertex + 1]; position++) {
+         int edge = incoming[position];
+         int from = sources[edge];
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         if (distance + weights[edge] < toTarget[from]) {
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            toTarget[from] = distance + weights[edge];
+            nextEdge[from] = edge;
+            heap.push_back(QueueElement(toTarget[from], from));
+            std::push_heap(heap.begin(), heap.end(), std::greater<QueueElement>());
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+         }
+      }
+   }
+   boundsTarget = target;
+}
+
+/*
+ A* search ordered by the distance from spur plus the distance to the target in the whole graph.
+ That estimate never decreases along an edge, so a vertex is final when popped the first time.
+ The blocked vertices and edges are marked with the current stamp by the caller.
+ */
+template <typename T>
+double KShortestPaths<T>::spurSearch(int spur, int target, double bound, std::vector<int> & spurEdges, [[maybe_unused]] AlgorithmStats * stats) {
+   const double infinity = std::numeric_limits<double>::infinity();
+   spurEdges.clear();
+   heap.clear();
+   distances[spur] = 0.0;
+   reached[spur] = stamp;
+   heap.push_back(QueueElement(toTarget[spur], spur));
+   while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<QueueElement>());
+      auto [estimate, vertex] = heap.back();
+      heap.pop_back();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[vertex] == stamp) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      if (estimate >= bound) {
+         return infinity;   // Nothing shorter than the bound is left.
+      }
+      settled[vertex] = stamp;
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      if (vertex == target) {
+         for (int at = target; at != spur; at = sources[parentEdge[at]]) {
+            spurEdges.push_back(parentEdge[at]);
+         }
+         std::reverse(spurEdges.begin(), spurEdges.end());
+         return distances[target];
+      }
+      for (int edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+         int destination = targets[edge];
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         if (blockedEdge[edge] == stamp || blockedVertex[destination] == stamp || toTarget[destination] == infinity) {
+            continue;
+         }
+         double distance = distances[vertex] + weights[edge];
+         if (reached[destination] != stamp || distance < distances[destination]) {
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            reached[destination] = stamp;
+            distances[destination] = distance;
+            parentEdge[destination] = edge;
+            heap.push_back(QueueElement(distance + toTarget[destination], destination));
+            std::push_heap(heap.begin(), heap.end(), std::greater<QueueElement>());
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+         }
+      }
+   }
+   return infinity;
+}
+
+/*
+ Yen's algorithm. Found paths are in found, the candidates for the next path in candidates,
+ both as edge numbers. The candidates set also removes duplicate candidates.
+ */
+template <typename T>
+std::vector<RankedPath<T>> KShortestPaths<T>::search(const Vertex<T> & source, const Vertex<T> & target, int k, AlgorithmStats * stats) {
+   GRAPH_TRACE_SPAN("KShortestPaths::kShortestPaths");
+   StatsTimer timer(stats);
+   std::vector<RankedPath<T>> result;
+   prepare();
+   int from = indexOf(source);
+   int to = indexOf(target);
+   GRAPH_STATS_ADD(stats, lookups, 2);
+   if (k <= 0 || from < 0 || to < 0) {
+      return result;
+   }
+   searchDistancesTo(to, stats);
+   if (toTarget[from] == std::numeric_limits<double>::infinity()) {
+      return result;
+   }
+
+   // The shortest path follows the edges towards the target found by searchDistancesTo.
+   std::vector<IndexedPath> found;
+   found.push_back(IndexedPath(toTarget[from], {}));
+   for (int vertex = from; vertex != to; vertex = targets[nextEdge[vertex]]) {
+      found.back().second.push_back(nextEdge[vertex]);
+   }
+
+   std::set<IndexedPath> candidates;
+   std::vector<int> spurEdges;
+   while (static_cast<int>(found.size()) < k) {
+      const std::vector<int> previous = found.back().second;
+      const std::size_t needed = k - found.size();
+      double rootLength = 0.0;
+      for (std::size_t spurPosition = 0; spurPosition < previous.size(); spurPosition++) {
+         int spur = sources[previous[spurPosition]];
+         nextStamp();
+         // Root vertices before the spur may not be visited again, so paths stay loopless.
+         for (std::size_t position = 0; position < spurPosition; position++) {
+            blockedVertex[sources[previous[position]]] = stamp;
+         }
+         // Found paths with the same root may not leave the spur by the same edge again.
+         for (const auto & path : found) {
+            if (path.second.size() > spurPosition &&
+                std::equal(previous.begin(), previous.begin() + spurPosition, path.second.begin())) {
+               blockedEdge[path.second[spurPosition]] = stamp;
+            }
+         }
+         // The candidate can be no shorter than the root plus the distance to the target without blocks.
+         double bound = std::numeric_limits<double>::infinity();
+         if (candidates.size() >= needed) {
+            bound = std::prev(candidates.end())->first - rootLength;
+         }
+         if (toTarget[spur] < bound) {
+            double spurLength = spurSearch(spur, to, bound, spurEdges, stats);
+            if (spurLength < bound) {
+               IndexedPath candidate(rootLength + spurLength, std::vector<int>(previous.begin(), previous.begin() + spurPosition));
+               candidate.second.insert(candidate.second.end(), spurEdges.begin(), spurEdges.end());
+               candidates.insert(std::move(candidate));
+               // Only the best ones can ever be used.
+               if (candidates.size() > needed) {
+                  candidates.erase(std::prev(candidates.end()));
+               }
+            }
+         }
+         rootLength += weights[previous[spurPosition]];
+      }
+      if (candidates.empty()) {
+         break;
+      }
+      found.push_back(*candidates.begin());
+      candidates.erase(candidates.begin());
+   }
+
+   for (const auto & [length, edges] : found) {
+      RankedPath<T> path = {length, {}};
+      path.edges.reserve(edges.size());
+      for (int edge : edges) {
+         path.edges.push_back(Edge<T>(vertices[sources[edge]], vertices[targets[edge]], weights[edge]));
+      }
+      result.push_back(std::move(path));
+   }
+   return result;
+}
+
+#endif /* KShortestPaths_hpp */
@@ -0,0 +1,641 @@
+#ifndef Landmarks_hpp
+#define Landmarks_hpp
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <random>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+#include "Graph.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// How Landmarks::select chooses the landmarks.
+enum LandmarkSelection {
+   EFarthestSelection,   // Each landmark is the vertex farthest from the landmarks chosen before it.
+   EAvoidSelection       // Each landmark is in the part of the graph the landmarks before it bound worst.
+};
+
+/**
+ Answers shortest path queries between two vertices with A* search, using the distances to
+ and from a few landmark vertices as the lower bounds (ALT: A*, landmarks and the triangle
+ inequality). Needs no coordinates, so it works on any graph with non-negative weights.
+
+ If d(L, v) is the distance from a landmark L to v, the triangle inequality gives
+ d(v, t) >= d(L, t) - d(L, v), and with the distances to the landmark, d(v, t) >= d(v, L) - d(t, L).
+ The largest of these over the landmarks is the lower bound. Landmarks behind the target,
+ seen from the source, give tight bounds, and the search goes straight towards the target,
+ settling only a fraction of the vertices Dijkstra would.
+
+ The landmarks are chosen once by select(), searching the distances from and to each of them.
+ The distances are kept as floats, rounded down, so they take 4 bytes per vertex and landmark
+ in each direction; for undirected graphs the two directions are the same and kept once.
+ The bounds use the float after the rounded one for the subtracted distance, so they never
+ exceed the real distance. The tables can be written to a stream and read back, to choose
+ the landmarks of a large graph only once.
+
+ The graph, without its dangling edges, is copied to arrays when the object is made, so later
+ changes of the graph are not seen. The searches reuse the same arrays, so an object should
+ be used by one thread at a time.
+ */
+template <typename T>
+class Landmarks {
+public:
+   Landmarks(const Graph<T> & graph, EdgeType type);
+
+   /// Chooses count landmarks and searches the distances between them and the other vertices.
+   /// The seed chooses the first vertex the selection starts from.
+   void select(int count, LandmarkSelection selection = EAvoidSelection, unsigned long seed = 1);
+   /// Number of landmarks, zero before select() or readTables().
+   int landmarkCount() const;
+   /// The landmark vertices.
+   std::vector<Vertex<T>> landmarks() const;
+   /// Uses at most count landmarks in each search, the ones giving the best bound at the source.
+   /// Fewer landmarks make computing the bounds faster; the default is 4. Zero uses all of them.
+   void setActiveLandmarks(int count);
+
+   /// Length of the shortest path from source to target, infinity if it cannot be reached.
+   double distance(const Vertex<T> & source, const Vertex<T> & target);
+   /// Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   double distance(const Vertex<T> & source, const Vertex<T> & target, AlgorithmStats & stats);
+   /// Edges of a shortest path from source to target, from the first to the last.
+   /// Empty if target cannot be reached, or is the source.
+   std::vector<Edge<T>> shortestPath(const Vertex<T> & source, const Vertex<T> & target);
+
+   /// Writes the landmarks and their distance tables. Returns false if writing failed.
+   bool writeTables(std::ostream & stream) const;
+   /// Reads the tables written by writeTables for the same graph. Returns false, keeping the
+   /// current tables, if the stream does not have tables or they were made for another graph.
+   bool readTables(std::istream & stream);
+
+private:
+   typedef std::pair<double, int> QueueElement;
+
+   double distance(const Vertex<T> & source, const Vertex<T> & target, AlgorithmStats * stats);
+   /// Searches the distances from the source, forward or backward along the edges,
+   /// optionally with the tree of the paths and the order the vertices were settled in.
+   void distancesFrom(int source, bool forward, std::vector<double> & distances, std::vector<int> * parents = nullptr, std::vector<int> * order = nullptr) const;
+   /// Searches the tables of the landmark number.
+   void fillTables(int landmark);
+   /// The vertex farthest from the landmarks chosen so far, unreached vertices first.
+   int farthestVertex(int start) const;
+   /// The leaf of the least covered subtree of the shortest path tree from root.
+   int avoidVertex(int root) const;
+   /// Lower bound of the distance from vertex to target with the landmark.
+   double bound(int landmark, int vertex, int target) const;
+   /// Does the A* search, returning the distance, parents left in the search arrays.
+   double search(int source, int target, AlgorithmStats * stats);
+   /// Hash of the edges, to tell if the tables were made for the graph.
+   std::uint64_t fingerprint() const;
+   int indexOf(const Vertex<T> & vertex) const;
+
+   static constexpr char magic[8] = {'G', 'R', 'P', 'H', 'L', 'M', 'R', 'K'};
+   static constexpr std::uint32_t formatVersion = 1;
+
+   std::vector<Vertex<T>> vertices;         // Graph order.
+   std::vector<std::size_t> offsets;        // Edges of vertex v are destinations[offsets[v]...offsets[v+1]-1].
+   std::vector<int> destinations;
+   std::vector<double> weights;
+   std::vector<std::size_t> reverseOffsets; // Edges into each vertex, for the distances to the landmarks.
+   std::vector<int> sources;
+   std::vector<double> reverseWeights;
+   bool directed;
+
+   std::vector<int> chosen;                 // Landmark vertices.
+   std::vector<float> fromLandmarks;        // d(L, v) at v * landmarks + L, rounded down.
+   std::vector<float> toLandmarks;          // d(v, L), only for directed graphs.
+   int active = 4;
+
+   // Search arrays, valid for the vertices marked with the current stamp.
+   std::vector<double> distances;
+   std::vector<double> bounds;
+   std::vector<int> parents;
+   std::vector<double> parentWeights;
+   std::vector<unsigned> marks;
+   unsigned stamp = 0;
+   std::vector<int> searchLandmarks;        // Landmarks used by the current search.
+};
+
+
+template <typename T>
+Landmarks<T>::Landmarks(const Graph<T> & graph, EdgeType type)
+: directed(type == EDirected) {
+   vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+   }
+   offsets.reserve(vertices.size() + 1);
+   offsets.push_back(0);
+   std::vector<std::size_t> incoming(vertices.size() + 1, 0);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = indexOf(edge.destination);
+         if (destination < 0) {
+            continue;
+         }
+         destinations.push_back(destination);
+         weights.push_back(edge.weight);
+         incoming[destination + 1]++;
+      }
+      offsets.push_back(destinations.size());
+   }
+   if (directed) {
+      for (std::size_t vertex = 1; vertex < incoming.size(); vertex++) {
+         incoming[vertex] += incoming[vertex - 1];
+      }
+      reverseOffsets = incoming;
+      sources.resize(destinations.size());
+      reverseWeights.resize(destinations.size());
+      for (int source = 0; source < static_cast<int>(vertices.size()); source++) {
+         for (std::size_t edge = offsets[source]; edge < offsets[source + 1]; edge++) {
+            std::size_t position = incoming[destinations[edge]]++;
+            sources[position] = source;
+            reverseWeights[position] = weights[edge];
+         }
+      }
+   }
+   distances.resize(vertices.size());
+   bounds.resize(vertices.size());
+   parents.resize(vertices.size());
+   parentWeights.resize(vertices.size());
+   marks.assign(vertices.size(), 0);
+}
+
+/*
+ The first landmark is the vertex farthest from a random vertex, so it is at the edge of
+ the graph. The tables of each landmark are searched before choosing the next one, since
+ both selections use the bounds of the landmarks chosen so far.
+ */
+template <typename T>
+void Landmarks<T>::select(int count, LandmarkSelection selection, unsigned long seed) {
+   GRAPH_TRACE_SPAN("Landmarks::select");
+   const int vertexCount = static_cast<int>(vertices.size());
+   count = std::max(0, std::min(count, vertexCount));
+   chosen.clear();
+   fromLandmarks.assign(static_cast<std::size_t>(vertexCount) * count, 0.0f);
+   toLandmarks.assign(directed ? fromLandmarks.size() : 0, 0.0f);
+   if (count == 0) {
+      return;
+   }
+   std::mt19937_64 random(seed);
+   int start = std::uniform_int_distribution<int>(0, vertexCount - 1)(random);
+   chosen.reserve(count);
+   while (static_cast<int>(chosen.size()) < count) {
+      int landmark = -1;
+      if (chosen.empty()) {
+         landmark = farthestVertex(start);
+      } else if (selection == EAvoidSelection) {
+         int root = std::uniform_int_distribution<int>(0, vertexCount - 1)(random);
+         landmark = avoidVertex(root);
+      }
+      if (landmark < 0 || std::find(chosen.begin(), chosen.end(), landmark) != chosen.end()) {
+         landmark = farthestVertex(start);
+      }
+      if (std::find(chosen.begin(), chosen.end(), landmark) != chosen.end()) {
+         break;   // Every vertex is already a landmark.
+      }
+      chosen.push_back(landmark);
+      fillTables(static_cast<int>(chosen.size()) - 1);
+   }
+   // The tables were made for count landmarks; keep only the ones chosen.
+   if (static_cast<int>(chosen.size()) < count) {
+      std::vector<float> from(static_cast<std::size_t>(vertexCount) * chosen.size());
+      std::vector<float> to(directed ? from.size() : 0);
+      for (int vertex = 0; vertex < vertexCount; vertex++) {
+         for (std::size_t landmark = 0; landmark < chosen.size(); landmark++) {
+            from[vertex * chosen.size() + landmark] = fromLandmarks[static_cast<std::size_t>(vertex) * count + landmark];
+            if (directed) {
+               to[vertex * chosen.size() + landmark] = toLandmarks[static_cast<std::size_t>(vertex) * count + landmark];
+            }
+         }
+      }
+      fromLandmarks.swap(from);
+      toLandmarks.swap(to);
+   }
+}
+
+template <typename T>
+int Landmarks<T>::landmarkCount() const {
+   return static_cast<int>(chosen.size());
+}
+
+template <typename T>
+std::vector<Vertex<T>> Landmarks<T>::landmarks() const {
+   std::vector<Vertex<T>> result;
+   for (int landmark : chosen) {
+      result.push_back(vertices[landmark]);
+   }
+   return result;
+}
+
+template <typename T>
+void Landmarks<T>::setActiveLandmarks(int count) {
+   active = std::max(0, count);
+}
+
+template <typename T>
+double Landmarks<T>::distance(const Vertex<T> & source, const Vertex<T> & target) {
+   return distance(source, target, nullptr);
+}
+
+template <typename T>
+double Landmarks<T>::distance(const Vertex<T> & source, const Vertex<T> & target, AlgorithmStats & stats) {
+   return distance(source, target, &stats);
+}
+
+template <typename T>
+double Landmarks<T>::distance(const Vertex<T> & source, const Vertex<T> & target, AlgorithmStats * stats) {
+   StatsTimer timer(stats);
+   int sourceIndex = indexOf(source);
+   int targetIndex = indexOf(target);
+   GRAPH_STATS_ADD(stats, lookups, 2);
+   if (sourceIndex < 0 || targetIndex < 0) {
+      return std::numeric_limits<double>::infinity();
+   }
+   return search(sourceIndex, targetIndex, stats);
+}
+
+template <typename T>
+std::vector<Edge<T>> Landmarks<T>::shortestPath(const Vertex<T> & source, const Vertex<T> & target) {
+   std::vector<Edge<T>> path;
+   int sourceIndex = indexOf(source);
+   int targetIndex = indexOf(target);
+   if (sourceIndex < 0 || targetIndex < 0 || search(sourceIndex, targetIndex, nullptr) == std::numeric_limits<double>::infinity()) {
+      return path;
+   }
+   for (int vertex = targetIndex; vertex != sourceIndex; vertex = parents[vertex]) {
+      path.push_back(Edge<T>(vertices[parents[vertex]], vertices[vertex], parentWeights[vertex]));
+   }
+   std::reverse(path.begin(), path.end());
+   return path;
+}
+
+/*
+ Header, the landmarks as vertex indices and the tables, all in the byte order of the machine
+ like the binary graph files. The vertex and edge counts and a hash of the edges tell if
+ the tables belong to the graph.
+ */
+template <typename T>
+bool Landmarks<T>::writeTables(std::ostream & stream) const {
+   auto put = [&stream](auto value) {
+      stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+   };
+   stream.write(magic, sizeof(magic));
+   put(formatVersion);
+   put(static_cast<std::int32_t>(vertices.size()));
+   put(static_cast<std::int64_t>(destinations.size()));
+   put(fingerprint());
+   put(static_cast<std::int32_t>(directed ? 1 : 0));
+   put(static_cast<std::int32_t>(chosen.size()));
+   for (int landmark : chosen) {
+      put(static_cast<std::int32_t>(landmark));
+   }
+   stream.write(reinterpret_cast<const char *>(fromLandmarks.data()), fromLandmarks.size() * sizeof(float));
+   stream.write(reinterpret_cast<const char *>(toLandmarks.data()), toLandmarks.size() * sizeof(float));
+   return static_cast<bool>(stream);
+}
+
+template <typename T>
+bool Landmarks<T>::readTables(std::istream & stream) {
+   auto get = [&stream](auto & value) {
+      return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(value)));
+   };
+   char header[sizeof(magic)];
+   std::uint32_t version = 0;
+   std::int32_t vertexCount = 0;
+   std::int64_t edgeCount = 0;
+   std::uint64_t hash = 0;
+   std::int32_t directedFlag = 0;
+   std::int32_t count = 0;
+   if (!stream.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0 ||
+       !get(version) || version != formatVersion || !get(vertexCount) || !get(edgeCount) || !get(hash) ||
+       !get(directedFlag) || !get(count) || vertexCount != static_cast<std::int32_t>(vertices.size()) ||
+       edgeCount != static_cast<std::int64_t>(destinations.size()) || hash != fingerprint() ||
+       (directedFlag != 0) != directed || count < 0 || count > vertexCount) {
+      return false;
+   }
+   std::vector<int> landmarks(count);
+   for (auto & landmark : landmarks) {
+      std::int32_t value;
+      if (!get(value) || value < 0 || value >= vertexCount) {
+         return false;
+      }
+      landmark = value;
+   }
+   std::vector<float> from(static_cast<std::size_t>(vertexCount) * count);
+   std::vector<float> to(directed ? from.size() : 0);
+   if (!stream.read(reinterpret_cast<char *>(from.data()), from.size() * sizeof(float)) ||
+       !stream.read(reinterpret_cast<char *>(to.data()), to.size() * sizeof(float))) {
+      return false;
+   }
+   chosen.swap(landmarks);
+   fromLandmarks.swap(from);
+   toLandmarks.swap(to);
+   return true;
+}
+
+template <typename T>
+void Landmarks<T>::distancesFrom(int source, bool forward, std::vector<double> & found, std::vector<int> * tree, std::vector<int> * order) const {
+   const auto & edgeOffsets = forward || !directed ? offsets : reverseOffsets;
+   const auto & edgeEnds = forward || !directed ? destinations : sources;
+   const auto & edgeWeights = forward || !directed ? weights : reverseWeights;
+   found.assign(vertices.size(), std::numeric_limits<double>::infinity());
+   if (tree) {
+      tree->assign(vertices.size(), -1);
+   }
+   if (order) {
+      order->clear();
+   }
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+   found[source] = 0.0;
+   queue.push(QueueElement(0.0, source));
+   while (!queue.empty()) {
+      auto [distance, vertex] = queue.top();
+      queue.pop();
+      if (distance > found[vertex]) {
+         continue;
+      }
+      if (order) {
+         order->push_back(vertex);
+      }
+      for (std::size_t edge = edgeOffsets[vertex]; edge < edgeOffsets[vertex + 1]; edge++) {
+         double candidate = distance + edgeWeights[edge];
+         if (candidate < found[edgeEnds[edge]]) {
+            found[edgeEnds[edge]] = candidate;
+            if (tree) {
+               (*tree)[edgeEnds[edge]] = vertex;
+            }
+            queue.push(QueueElement(candidate, edgeEnds[edge]));
+         }
+      }
+   }
+}
+
+/*
+ Floats are rounded down, so that a distance read from the table is never too long.
+ */
+template <typename T>
+void Landmarks<T>::fillTables(int landmark) {
+   const std::size_t stride = fromLandmarks.size() / vertices.size();
+   auto roundDown = [](double distance) {
+      float rounded = static_cast<float>(distance);
+      if (rounded > distance) {
+         rounded = std::nextafter(rounded, -std::numeric_limits<float>::infinity());
+      }
+      return rounded;
+   };
+   std::vector<double> found;
+   distancesFrom(chosen[landmark], true, found);
+   for (std::size_t vertex = 0; vertex < vertices.size(); vertex++) {
+      fromLandmarks[vertex * stride + landmark] = roundDown(found[vertex]);
+   }
+   if (directed) {
+      distancesFrom(chosen[landmark], false, found);
+      for (std::size_t vertex = 0; vertex < vertices.size(); vertex++) {
+         toLandmarks[vertex * stride + landmark] = roundDown(found[vertex]);
+      }
+   }
+}
+
+/*
+ Searches from all the landmarks at once, or from start if there are none yet.
+ */
+template <typename T>
+int Landmarks<T>::farthestVertex(int start) const {
+   std::vector<double> nearest(vertices.size(), std::numeric_limits<double>::infinity());
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+   if (chosen.empty()) {
+      nearest[start] = 0.0;
+      queue.push(QueueElement(0.0, start));
+   }
+   for (int landmark : chosen) {
+      nearest[landmark] = 0.0;
+      queue.push(QueueElement(0.0, landmark));
+   }
+   while (!queue.empty()) {
+      auto [distance, vertex] = queue.top();
+      queue.pop();
+      if (distance > nearest[vertex]) {
+         continue;
+      }
+      for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+         double candidate = distance + weights[edge];
+         if (candidate < nearest[destinations[edge]]) {
+            nearest[destinations[edge]] = candidate;
+            queue.push(QueueElement(candidate, destinations[edge]));
+         }
+      }
+   }
+   return static_cast<int>(std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+}
+
+/*
+ The avoid heuristic of Goldberg and Werneck: in the shortest path tree from root, each vertex
+ weighs the difference of its distance and the lower bound the landmarks give for it. A subtree
+ with a landmark in it weighs nothing, since the landmark already bounds it well. Going down
+ from the root to the heaviest child each time, the leaf reached is the next landmark.
+ */
+template <typename T>
+int Landmarks<T>::avoidVertex(int root) const {
+   std::vector<double> found;
+   std::vector<int> tree;
+   std::vector<int> order;
+   distancesFrom(root, true, found, &tree, &order);
+   const int vertexCount = static_cast<int>(vertices.size());
+   // Going back in the settling order, each subtree is summed before its root.
+   std::reverse(order.begin(), order.end());
+   std::vector<double> sizes(vertexCount, 0.0);
+   std::vector<bool> covered(vertexCount, false);
+   for (int landmark : chosen) {
+      covered[landmark] = true;
+   }
+   for (int vertex : order) {
+      double best = 0.0;
+      for (std::size_t landmark = 0; landmark < chosen.size(); landmark++) {
+         best = std::max(best, bound(static_cast<int>(landmark), root, vertex));
+      }
+      sizes[vertex] += found[vertex] - best;
+      if (covered[vertex]) {
+         sizes[vertex] = 0.0;
+      }
+      if (tree[vertex] >= 0) {
+         sizes[tree[vertex]] += sizes[vertex];
+         if (covered[vertex]) {
+            covered[tree[vertex]] = true;
+         }
+      }
+   }
+   // Children of each vertex in the tree, to go down from the root.
+   std::vector<int> childOffsets(vertexCount + 1, 0);
+   for (int vertex : order) {
+      if (tree[vertex] >= 0) {
+         childOffsets[tree[vertex] + 1]++;
+      }
+   }
+   for (int vertex = 0; vertex < vertexCount; vertex++) {
+      childOffsets[vertex + 1] += childOffsets[vertex];
+   }
+   std::vector<int> children(order.size());
+   std::vector<int> position(childOffsets.begin(), childOffsets.end() - 1);
+   for (int vertex : order) {
+      if (tree[vertex] >= 0) {
+         children[position[tree[vertex]]++] = vertex;
+      }
+   }
+   if (covered[root] && sizes[root] <= 0.0) {
+      return -1;
+   }
+   int vertex = root;
+   while (childOffsets[vertex] < childOffsets[vertex + 1]) {
+      int heaviest = -1;
+      for (int child = childOffsets[vertex]; child < childOffsets[vertex + 1]; child++) {
+         if (heaviest < 0 || sizes[children[child]] > sizes[heaviest]) {
+            heaviest = children[child];
+         }
+      }
+      if (sizes[heaviest] <= 0.0) {
+         break;
+      }
+      vertex = heaviest;
+   }
+   return covered[vertex] ? -1 : vertex;
+}
+
+/*
+ A landmark that cannot reach the vertex (or be reached from it) gives no bound with the
+ subtracted distance, but if it reaches the vertex and not the target, the target cannot be
+ reached from the vertex at all.
+ */
+template <typename T>
+double Landmarks<T>::bound(int landmark, int vertex, int target) const {
+   const double infinity = std::numeric_limits<double>::infinity();
+   const std::size_t stride = chosen.size();
+   auto upper = [](float distance) {
+      return static_cast<double>(std::nextafter(distance, std::numeric_limits<float>::infinity()));
+   };
+   double best = 0.0;
+   float fromVertex = fromLandmarks[vertex * stride + landmark];
+   float fromTarget = fromLandmarks[target * stride + landmark];
+   if (fromVertex < infinity) {
+      best = std::max(best, fromTarget - upper(fromVertex));
+   }
+   const std::vector<float> & to = directed ? toLandmarks : fromLandmarks;
+   float toVertex = to[vertex * stride + landmark];
+   float toTarget = to[target * stride + landmark];
+   if (toTarget < infinity) {
+      best = std::max(best, toVertex - upper(toTarget));
+   }
+   return best;
+}
+
+/*
+ The bounds of the landmarks are not exactly consistent after rounding, so a vertex found
+ again with a shorter distance is searched again; the search stops when the target is taken
+ from the queue, as A* with a lower bound does.
+ */
+template <typename T>
+double Landmarks<T>::search(int source, int target, AlgorithmStats * stats) {
+   GRAPH_TRACE_SPAN("Landmarks::search");
+   const double infinity = std::numeric_limits<double>::infinity();
+   if (++stamp == 0) {
+      std::fill(marks.begin(), marks.end(), 0);
+      stamp = 1;
+   }
+   // The landmarks giving the best bounds at the source are likely the best near it too.
+   searchLandmarks.resize(chosen.size());
+   std::iota(searchLandmarks.begin(), searchLandmarks.end(), 0);
+   if (active > 0 && static_cast<int>(searchLandmarks.size()) > active) {
+      std::partial_sort(searchLandmarks.begin(), searchLandmarks.begin() + active, searchLandmarks.end(), [&](int first, int second) {
+         return bound(first, source, target) > bound(second, source, target);
+      });
+      searchLandmarks.resize(active);
+   }
+   auto lowerBound = [&](int vertex) {
+      double best = 0.0;
+      for (int landmark : searchLandmarks) {
+         best = std::max(best, bound(landmark, vertex, target));
+      }
+      return best;
+   };
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+   GrowthCounter queueGrowth(stats);
+   marks[source] = stamp;
+   distances[source] = 0.0;
+   bounds[source] = lowerBound(source);
+   parents[source] = -1;
+   if (bounds[source] == infinity) {
+      return infinity;
+   }
+   queue.push(QueueElement(bounds[source], source));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   while (!queue.empty()) {
+      auto [estimate, vertex] = queue.top();
+      queue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (estimate > distances[vertex] + bounds[vertex]) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      if (vertex == target) {
+         return distances[target];
+      }
+      for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         int destination = destinations[edge];
+         double candidate = distances[vertex] + weights[edge];
+         if (marks[destination] != stamp) {
+            marks[destination] = stamp;
+            distances[destination] = infinity;
+            bounds[destination] = lowerBound(destination);
+         }
+         if (candidate < distances[destination] && bounds[destination] < infinity) {
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            distances[destination] = candidate;
+            parents[destination] = vertex;
+            parentWeights[destination] = weights[edge];
+            queue.push(QueueElement(candidate + bounds[destination], destination));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(queue.size());
+         }
+      }
+   }
+   return infinity;
+}
+
+/*
+ FNV-1a over the destinations and the weights of the edges.
+ */
+template <typename T>
+std::uint64_t Landmarks<T>::fingerprint() const {
+   std::uint64_t hash = 14695981039346656037ull;
+   auto mix = [&hash](const void * data, std::size_t size) {
+      const unsigned char * bytes = static_cast<const unsigned char *>(data);
+      for (std::size_t byte = 0; byte < size; byte++) {
+         hash = (hash ^ bytes[byte]) * 1099511628211ull;
+      }
+   };
+   mix(offsets.data(), offsets.size() * sizeof(std::size_t));
+   mix(destinations.data(), destinations.size() * sizeof(int));
+   mix(weights.data(), weights.size() * sizeof(double));
+   return hash;
+}
+
+template <typename T>
+int Landmarks<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - vertices.begin());
+}
+
+#endif /* Landmarks_hpp */
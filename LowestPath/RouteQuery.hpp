@@ -0,0 +1,146 @@
+//
+//  RouteQuery.hpp
+//  LowestPath
+//
+//  Answers many lowest route queries on a graph loaded once.
+//
+
+#ifndef RouteQuery_hpp
+#define RouteQuery_hpp
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+
+#include "Dijkstra.hpp"
+
+/// A query for the lowest route from start city to the target city.
+struct RouteQuery {
+   int start;
+   int target;
+};
+
+/// Answer to a RouteQuery.
+struct RouteAnswer {
+   int start = 0;
+   int target = 0;
+   bool found = false;             // Can the target be reached from start.
+   double maxHeight = 0.0;         // Highest edge on the route.
+   double total = 0.0;             // Sum of the edge weights on the route.
+   int hops = 0;                   // Number of edges on the route.
+   double latencyMicroseconds = 0.0;
+};
+
+/// Reads queries, one "start target" pair per line. Empty lines and lines starting with #
+/// are skipped. Returns false and the line number in errorLine if a line is not valid.
+inline bool readQueries(std::istream & stream, std::vector<RouteQuery> & queries, int & errorLine) {
+   std::string line;
+   int lineNumber = 0;
+   while (std::getline(stream, line)) {
+      lineNumber++;
+      auto first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#') {
+         continue;
+      }
+      std::istringstream iss(line);
+      RouteQuery query;
+      if (!(iss >> query.start >> query.target)) {
+         errorLine = lineNumber;
+         return false;
+      }
+      queries.push_back(query);
+   }
+   return true;
+}
+
+/// Answers the query from the lowest or shortest paths searched from the start of the query.
+/// Route buffer is reused between the calls to avoid allocating.
+inline RouteAnswer answerQuery(const ShortestPathTree<int> & paths, const RouteQuery & query, std::vector<int> & route) {
+   RouteAnswer answer;
+   answer.start = query.start;
+   answer.target = query.target;
+   int index = paths.indexOf(Vertex<int>(query.target));
+   if (index < 0 || !paths.reaches(index)) {
+      return answer;
+   }
+   answer.found = true;
+   answer.hops = paths.routeTo(index, route);
+   for (std::size_t step = 1; step < route.size(); step++) {
+      double weight = paths.weightTo(route[step]);
+      answer.total += weight;
+      answer.maxHeight = std::max(answer.maxHeight, weight);
+   }
+   return answer;
+}
+
+/*
+ Answers the queries with the number of threads given, answers in the order of the queries.
+ Queries are grouped by their start city, so lowest paths from each start are searched only
+ once, and the threads take the groups one by one. Latency of a query is the time from
+ starting the search of its group to having the answer.
+ */
+inline std::vector<RouteAnswer> answerQueries(const Dijkstra<int> & dijkstra, const std::vector<RouteQuery> & queries, int threads) {
+   std::vector<std::size_t> order(queries.size());
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(), [&queries](std::size_t lhs, std::size_t rhs) {
+      return queries[lhs].start < queries[rhs].start;
+   });
+   // Positions in order where a group of queries with the same start begins, and the end.
+   std::vector<std::size_t> groups;
+   for (std::size_t position = 0; position < order.size(); position++) {
+      if (position == 0 || queries[order[position]].start != queries[order[position - 1]].start) {
+         groups.push_back(position);
+      }
+   }
+   groups.push_back(order.size());
+
+   std::vector<RouteAnswer> answers(queries.size());
+   std::atomic<std::size_t> nextGroup(0);
+   auto worker = [&]() {
+      std::vector<int> route;
+      for (std::size_t group = nextGroup++; group + 1 < groups.size(); group = nextGroup++) {
+         auto started = std::chrono::steady_clock::now();
+         auto paths = dijkstra.lowestPathTreeFrom(Vertex<int>(queries[order[groups[group]]].start));
+         for (std::size_t position = groups[group]; position < groups[group + 1]; position++) {
+            RouteAnswer & answer = answers[order[position]];
+            answer = answerQuery(*paths, queries[order[position]], route);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - started;
+            answer.latencyMicroseconds = elapsed.count();
+         }
+      }
+   };
+   threads = std::max(1, std::min(threads, static_cast<int>(groups.size()) - 1));
+   std::vector<std::thread> pool;
+   for (int thread = 1; thread < threads; thread++) {
+      pool.emplace_back(worker);
+   }
+   worker();
+   for (auto & thread : pool) {
+      thread.join();
+   }
+   return answers;
+}
+
+/// Writes the answers as tab separated lines, with a header line naming the columns.
+/// Max height and total are "-" when the target cannot be reached.
+inline void writeAnswers(std::ostream & stream, const std::vector<RouteAnswer> & answers) {
+   stream << "start\ttarget\tfound\tmax_height\ttotal\thops\tlatency_us\n";
+   for (const auto & answer : answers) {
+      stream << answer.start << '\t' << answer.target << '\t' << (answer.found ? 1 : 0) << '\t';
+      if (answer.found) {
+         stream << answer.maxHeight << '\t' << answer.total << '\t' << answer.hops;
+      } else {
+         stream << "-\t-\t-";
+      }
+      stream << '\t' << static_cast<long>(answer.latencyMicroseconds) << '\n';
+   }
+}
+
+#endif /* RouteQuery_hpp */
@@ -0,0 +1,668 @@
+//
+//  RouteServer.hpp
+//  LowestPath
+//
+//  Serves route queries on a loaded graph over a UNIX domain socket.
+//
+
+#ifndef RouteServer_hpp
+#define RouteServer_hpp
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Dijkstra.hpp"
+#include "ParetoRouting.hpp"
+#include "VersionedGraph.hpp"
+#include "RouteQuery.hpp"
+
+/// Keeps a loaded graph in memory and answers route queries sent to a UNIX domain socket.
+///
+/// The protocol is line based. Each request line gets one response line, in the order of
+/// the requests of the connection. Clients may send many requests without waiting for the
+/// responses (pipelining); the requests are answered by a pool of worker threads.
+///
+/// Requests:
+///  - lowest start target    route where the highest edge is the lowest
+///  - shortest start target  route with the smallest sum of edge weights
+///  - pareto start target    the routes that are the best trade-offs between the two above
+///  - close a b              removes the edge between cities a and b
+///  - open a b height        adds the edge between cities a and b, or changes its height
+///  - stats                  queue depth, number of queries served and latency percentiles
+///  - ping                   answered with pong
+///  - shutdown               stops the server after answering the queued queries
+///
+/// Responses to route queries are "ok start target max_height total hops latency_us",
+/// or "none start target latency_us" if the target cannot be reached from start.
+/// Pareto queries are answered with "ok start target routes max_height total hops ... latency_us",
+/// giving the three numbers for each route, from the lowest route to the shortest one.
+/// With a latency budget, a query not answered within the budget from reading it is
+/// stopped, also while waiting in the queue, and answered with "timeout start target latency_us".
+/// Latency is the time from reading the request to having the answer, including the
+/// time the request waited in the queue. Invalid requests are answered with "error message".
+///
+/// Changes are applied to a new version of the graph while the queries are answered from
+/// the earlier version, so queries do not wait for the changes. The changes waiting when
+/// a version is made are applied together, and each is answered with "ok version n" when
+/// the version including it is published, or with "none a b" if there was no edge to close.
+/// A query is answered from the latest version published when the query was read.
+///
+/// The paths searched stay in the path cache of the version, so queries from the same
+/// start cities are answered without searching again until the graph changes.
+///
+/// Each connection writes its responses from its own thread, so a client that does not read
+/// its responses only holds up itself: the workers and the changes never wait for a socket.
+/// Such a client's requests are not read while too many of its responses are waiting.
+class RouteServer {
+public:
+   /// Queries taking longer than the budget are stopped; zero budget lets them run to the end.
+   RouteServer(VersionedGraph<int> & network, int threads, std::chrono::microseconds budget = std::chrono::microseconds(0));
+   ~RouteServer();
+   RouteServer(const RouteServer &) = delete;
+   const RouteServer & operator = (const RouteServer &) = delete;
+
+   /// Listens to the socket and serves the clients until shutdown is requested or the
+   /// process gets SIGINT or SIGTERM. Returns false if the socket could not be opened.
+   bool run(const std::string & socketPath);
+   /// Asks the server to stop. Queries already received are answered first.
+   void stop();
+
+private:
+   /// A client connection. Responses are written in the order of the requests, so
+   /// answers finished early wait in ready until the earlier ones are in outgoing.
+   /// The thread of the connection writes outgoing to the socket; the others only
+   /// add to it and wake the thread through the pipe.
+   struct Connection {
+      int socket;
+      int wake[2] = {-1, -1};                    // Pipe, read end first.
+      std::mutex mutex;                          // Guards the members below.
+      unsigned long received = 0;                // Sequence number of the next request.
+      unsigned long nextToWrite = 0;             // Sequence number of the next response to add to outgoing.
+      std::map<unsigned long, std::string> ready;
+      std::string outgoing;                      // Responses in order, not yet taken by the thread.
+      bool broken = false;                       // Writing failed, the client is gone.
+      std::atomic<bool> finished{false};
+
+      /// The pipe is closed by the last one holding the connection, so that the workers
+      /// still replying to it do not write to a closed descriptor.
+      ~Connection() {
+         for (int descriptor : wake) {
+            if (descriptor >= 0) {
+               close(descriptor);
+            }
+         }
+      }
+   };
+
+   /// A route query waiting for a worker.
+   struct Job {
+      std::shared_ptr<Connection> connection;
+      unsigned long sequence;
+      PathAlgorithm algorithm;
+      bool pareto;                             // All the best trade-offs, not only one route.
+      RouteQuery query;
+      std::chrono::steady_clock::time_point received;
+      VersionedGraph<int>::Snapshot graph;     // Version of the graph to answer from.
+   };
+
+   /// A change of the graph waiting for the next version.
+   struct Change {
+      std::shared_ptr<Connection> connection;
+      unsigned long sequence;
+      bool open;                                // Open (add) or close (remove) the edge.
+      int from;
+      int to;
+      int height;
+   };
+
+   void serve(std::shared_ptr<Connection> connection);
+   void handle(const std::shared_ptr<Connection> & connection, const std::string & line);
+   void work();
+   void answerPareto(const Job & job, const CancellationToken & token);
+   void applyChanges();
+   void reply(Connection & connection, unsigned long sequence, std::string response);
+   /// Writes as much of sending as the socket takes without blocking. Returns false if the client is gone.
+   bool send(Connection & connection, std::string & sending);
+   void recordLatency(double microseconds);
+   std::string statistics();
+
+   static void interrupt(int);
+   static inline volatile std::sig_atomic_t interrupted = 0;
+
+   VersionedGraph<int> & network;
+   int threadCount;
+   std::chrono::microseconds budget;
+   std::atomic<unsigned long> timedOut{0};
+   std::atomic<bool> stopping{false};
+
+   std::mutex jobsMutex;                     // Guards the jobs and the counters below.
+   std::condition_variable jobsAvailable;
+   std::deque<Job> jobs;
+   bool workersDone = false;
+   std::size_t maxQueueDepth = 0;
+   std::deque<Change> changes;               // Guarded by jobsMutex.
+   std::condition_variable changesAvailable;
+
+   /// Pareto routing of a version of the graph, given by the future once made.
+   struct ParetoEntry {
+      std::weak_ptr<const Graph<int>> graph;
+      std::shared_future<std::shared_ptr<const ParetoRouting<int>>> routing;
+   };
+   std::mutex paretoMutex;                   // Guards the routings.
+   std::vector<ParetoEntry> paretoRoutings;  // One for each version still in use.
+
+   std::mutex latencyMutex;
+   std::vector<double> latencies;            // Latest latencies, a ring buffer.
+   std::size_t latencyCount = 0;
+
+   std::vector<std::thread> workers;
+   std::thread updater;
+   std::vector<std::pair<std::shared_ptr<Connection>, std::thread>> connections;
+
+   static constexpr unsigned long maxUnanswered = 4096;      // Requests of a connection read but not yet written.
+   static constexpr std::size_t maxUnsent = 1 << 20;         // Bytes of responses not yet taken by the client.
+   static constexpr std::chrono::seconds drainTime{5};       // Time given to a client to read its responses when stopping.
+};
+
+
+inline RouteServer::RouteServer(VersionedGraph<int> & network, int threads, std::chrono::microseconds budget)
+: network(network), threadCount(std::max(1, threads)), budget(budget), latencies(65536) {
+}
+
+inline RouteServer::~RouteServer() {
+   stop();
+}
+
+inline void RouteServer::interrupt(int) {
+   interrupted = 1;
+}
+
+inline void RouteServer::stop() {
+   stopping = true;
+}
+
+/*
+ The listening socket is polled with a timeout, so that a stop request or a signal
+ is noticed also when no clients are connecting. When stopping, the connections stop
+ reading, wait until their queued queries are answered, and then the workers end.
+ */
+inline bool RouteServer::run(const std::string & socketPath) {
+   sockaddr_un address;
+   std::memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (socketPath.size() >= sizeof(address.sun_path)) {
+      return false;
+   }
+   std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+   // A socket file left by a previous server that was killed would make bind fail.
+   struct stat status;
+   if (stat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+      unlink(socketPath.c_str());
+   }
+   int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (listener < 0) {
+      return false;
+   }
+   if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+      close(listener);
+      return false;
+   }
+   std::signal(SIGPIPE, SIG_IGN);
+   std::signal(SIGINT, interrupt);
+   std::signal(SIGTERM, interrupt);
+
+   for (int thread = 0; thread < threadCount; thread++) {
+      workers.emplace_back(&RouteServer::work, this);
+   }
+   updater = std::thread(&RouteServer::applyChanges, this);
+   while (!stopping && !interrupted) {
+      pollfd listening = {listener, POLLIN, 0};
+      if (poll(&listening, 1, 200) > 0 && (listening.revents & POLLIN)) {
+         int client = accept(listener, nullptr, nullptr);
+         if (client >= 0) {
+            auto connection = std::make_shared<Connection>();
+            connection->socket = client;
+            if (pipe(connection->wake) != 0) {
+               close(client);
+               continue;
+            }
+            for (int descriptor : {client, connection->wake[0], connection->wake[1]}) {
+               fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+            }
+            connections.emplace_back(connection, std::thread(&RouteServer::serve, this, connection));
+         }
+      }
+      // Join the threads of the clients that have disconnected.
+      for (auto iterator = connections.begin(); iterator != connections.end(); ) {
+         if (iterator->first->finished) {
+            iterator->second.join();
+            iterator = connections.erase(iterator);
+         } else {
+            ++iterator;
+         }
+      }
+   }
+   stopping = true;
+   close(listener);
+   unlink(socketPath.c_str());
+   // Connections notice stopping within the poll timeout and stop reading.
+   for (auto & [connection, thread] : connections) {
+      thread.join();
+   }
+   connections.clear();
+   {
+      std::lock_guard<std::mutex> guard(jobsMutex);
+      workersDone = true;
+   }
+   jobsAvailable.notify_all();
+   changesAvailable.notify_all();
+   for (auto & worker : workers) {
+      worker.join();
+   }
+   workers.clear();
+   updater.join();
+   return true;
+}
+
+/*
+ Reads the requests of a connection line by line and writes the responses, polling the
+ socket and the wake pipe, which the workers and the updater write to when responses are
+ ready. The socket is non-blocking, so a client that does not read makes this thread wait
+ in poll, not in write. While too many responses of the client are waiting, its requests
+ are not read, so the client cannot fill the queue of the workers or the memory.
+ After the client has closed its end, the remaining responses are written before closing
+ the socket. When stopping, a client not reading them is given drainTime to do so.
+ */
+inline void RouteServer::serve(std::shared_ptr<Connection> connection) {
+   std::string pending;
+   std::string sending;
+   char buffer[4096];
+   bool reading = true;
+   auto progressed = std::chrono::steady_clock::now();
+   while (true) {
+      bool answered;
+      bool broken;
+      unsigned long unanswered;
+      {
+         std::lock_guard<std::mutex> guard(connection->mutex);
+         sending += connection->outgoing;
+         connection->outgoing.clear();
+         answered = connection->nextToWrite == connection->received;
+         broken = connection->broken;
+         unanswered = connection->received - connection->nextToWrite;
+      }
+      if (broken) {
+         sending.clear();
+      }
+      if (sending.empty()) {
+         progressed = std::chrono::steady_clock::now();
+      }
+      if (stopping) {
+         reading = false;
+      }
+      if (!reading && answered && sending.empty()) {
+         break;
+      }
+      if (stopping && !sending.empty() && std::chrono::steady_clock::now() - progressed > drainTime) {
+         std::lock_guard<std::mutex> guard(connection->mutex);
+         connection->broken = true;
+         continue;
+      }
+      short events = 0;
+      if (reading && unanswered < maxUnanswered && sending.size() < maxUnsent) {
+         events |= POLLIN;
+      }
+      if (!sending.empty()) {
+         events |= POLLOUT;
+      }
+      // Without events the socket is left out, so that a hang up does not wake the poll
+      // over and over while the workers are answering.
+      pollfd descriptors[2] = {{broken || events == 0 ? -1 : connection->socket, events, 0}, {connection->wake[0], POLLIN, 0}};
+      if (poll(descriptors, 2, 200) <= 0) {
+         continue;
+      }
+      if (descriptors[1].revents & POLLIN) {
+         while (read(connection->wake[0], buffer, sizeof(buffer)) > 0) {
+            // Emptied, the responses are taken from outgoing on the next round.
+         }
+      }
+      if (descriptors[0].revents & (POLLOUT | POLLERR | POLLHUP)) {
+         std::size_t before = sending.size();
+         if (!send(*connection, sending)) {
+            std::lock_guard<std::mutex> guard(connection->mutex);
+            connection->broken = true;
+            reading = false;
+            continue;
+         }
+         if (sending.size() < before) {
+            progressed = std::chrono::steady_clock::now();
+         }
+      }
+      // A hang up is read as the end of the requests.
+      if (!reading || !(descriptors[0].revents & (POLLIN | POLLHUP))) {
+         continue;
+      }
+      ssize_t count = read(connection->socket, buffer, sizeof(buffer));
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+         continue;
+      }
+      if (count <= 0) {
+         reading = false;
+         continue;
+      }
+      pending.append(buffer, count);
+      std::size_t begin = 0;
+      for (std::size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', begin)) {
+         std::string line = pending.substr(begin, end - begin);
+         begin = end + 1;
+         if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+         }
+         if (line == "quit") {
+            reading = false;
+            break;
+         }
+         if (!line.empty()) {
+            handle(connection, line);
+         }
+      }
+      pending.erase(0, begin);
+   }
+   close(connection->socket);
+   connection->finished = true;
+}
+
+inline void RouteServer::handle(const std::shared_ptr<Connection> & connection, const std::string & line) {
+   unsigned long sequence;
+   {
+      std::lock_guard<std::mutex> guard(connection->mutex);
+      sequence = connection->received++;
+   }
+   std::istringstream iss(line);
+   std::string command;
+   iss >> command;
+   if (command == "lowest" || command == "shortest" || command == "pareto") {
+      RouteQuery query;
+      if (!(iss >> query.start >> query.target)) {
+         reply(*connection, sequence, "error expected: " + command + " start target");
+         return;
+      }
+      Job job = {connection, sequence, command == "lowest" ? ELowestPaths : EShortestPaths, command == "pareto", query, std::chrono::steady_clock::now(), network.snapshot()};
+      {
+         std::lock_guard<std::mutex> guard(jobsMutex);
+         jobs.push_back(job);
+         maxQueueDepth = std::max(maxQueueDepth, jobs.size());
+      }
+      jobsAvailable.notify_one();
+   } else if (command == "close" || command == "open") {
+      Change change = {connection, sequence, command == "open", 0, 0, 0};
+      if (!(iss >> change.from >> change.to) || (change.open && !(iss >> change.height))) {
+         reply(*connection, sequence, "error expected: " + command + (change.open ? " a b height" : " a b"));
+         return;
+      }
+      {
+         std::lock_guard<std::mutex> guard(jobsMutex);
+         changes.push_back(change);
+      }
+      changesAvailable.notify_one();
+   } else if (command == "stats") {
+      reply(*connection, sequence, statistics());
+   } else if (command == "ping") {
+      reply(*connection, sequence, "pong");
+   } else if (command == "shutdown") {
+      reply(*connection, sequence, "ok shutting down");
+      stop();
+   } else {
+      reply(*connection, sequence, "error unknown request: " + command);
+   }
+}
+
+inline void RouteServer::work() {
+   std::vector<int> route;
+   while (true) {
+      Job job;
+      {
+         std::unique_lock<std::mutex> lock(jobsMutex);
+         jobsAvailable.wait(lock, [this] { return !jobs.empty() || workersDone; });
+         if (jobs.empty()) {
+            return;
+         }
+         job = std::move(jobs.front());
+         jobs.pop_front();
+      }
+      Vertex<int> start(job.query.start);
+      CancellationToken token(budget.count() > 0 ? job.received + budget : CancellationToken::Clock::time_point::max());
+      if (job.pareto) {
+         answerPareto(job, token);
+         continue;
+      }
+      Dijkstra<int> dijkstra(*job.graph);
+      auto paths = job.algorithm == ELowestPaths ? dijkstra.lowestPathTreeFrom(start, token) : dijkstra.shortestPathTreeFrom(start, token);
+      RouteAnswer answer;
+      if (paths) {
+         answer = answerQuery(*paths, job.query, route);
+      }
+      std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - job.received;
+      recordLatency(elapsed.count());
+      std::ostringstream response;
+      if (!paths) {
+         timedOut++;
+         response << "timeout " << job.query.start << ' ' << job.query.target << ' ' << static_cast<long>(elapsed.count());
+      } else if (answer.found) {
+         response << "ok " << answer.start << ' ' << answer.target << ' ' << answer.maxHeight << ' '
+                  << answer.total << ' ' << answer.hops << ' ' << static_cast<long>(elapsed.count());
+      } else {
+         response << "none " << answer.start << ' ' << answer.target << ' ' << static_cast<long>(elapsed.count());
+      }
+      reply(*job.connection, job.sequence, response.str());
+   }
+}
+
+/*
+ Pareto routes are not kept in the path cache, each query is searched. The arrays of the
+ routing are made once for each version of the graph, by the first pareto query of it,
+ without holding the lock, and kept as long as the version is in use, so queries on
+ different versions do not make them again. The other queries of the version wait for
+ the arrays only until their deadline.
+ */
+inline void RouteServer::answerPareto(const Job & job, const CancellationToken & token) {
+   std::shared_future<std::shared_ptr<const ParetoRouting<int>>> routing;
+   std::promise<std::shared_ptr<const ParetoRouting<int>>> making;
+   bool makes = false;
+   {
+      std::lock_guard<std::mutex> guard(paretoMutex);
+      paretoRoutings.erase(std::remove_if(paretoRoutings.begin(), paretoRoutings.end(), [](const ParetoEntry & entry) {
+         return entry.graph.expired();
+      }), paretoRoutings.end());
+      auto found = std::find_if(paretoRoutings.begin(), paretoRoutings.end(), [&job](const ParetoEntry & entry) {
+         return entry.graph.lock() == job.graph;
+      });
+      if (found != paretoRoutings.end()) {
+         routing = found->routing;
+      } else {
+         routing = making.get_future().share();
+         paretoRoutings.push_back({job.graph, routing});
+         makes = true;
+      }
+   }
+   if (makes) {
+      making.set_value(std::make_shared<const ParetoRouting<int>>(*job.graph));
+   }
+   bool ready = true;
+   if (token.deadline() == CancellationToken::Clock::time_point::max()) {
+      routing.wait();
+   } else {
+      ready = routing.wait_until(token.deadline()) == std::future_status::ready;
+   }
+   std::vector<ParetoRoute<int>> routes;
+   if (ready) {
+      routes = routing.get()->routesBetween(Vertex<int>(job.query.start), Vertex<int>(job.query.target), token);
+   }
+   std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - job.received;
+   recordLatency(elapsed.count());
+   std::ostringstream response;
+   if (routes.empty() && token.isCancelled()) {
+      timedOut++;
+      response << "timeout " << job.query.start << ' ' << job.query.target << ' ' << static_cast<long>(elapsed.count());
+   } else if (!routes.empty()) {
+      response << "ok " << job.query.start << ' ' << job.query.target << ' ' << routes.size();
+      for (const auto & route : routes) {
+         response << ' ' << route.maxWeight << ' ' << route.distance << ' ' << route.edges.size();
+      }
+      response << ' ' << static_cast<long>(elapsed.count());
+   } else {
+      response << "none " << job.query.start << ' ' << job.query.target << ' ' << static_cast<long>(elapsed.count());
+   }
+   reply(*job.connection, job.sequence, response.str());
+}
+
+/*
+ Takes all the waiting changes and makes one new version of the graph with them, so the
+ graph is copied once for each batch of changes, however many there are.
+ */
+inline void RouteServer::applyChanges() {
+   while (true) {
+      std::vector<Change> batch;
+      {
+         std::unique_lock<std::mutex> lock(jobsMutex);
+         changesAvailable.wait(lock, [this] { return !changes.empty() || workersDone; });
+         if (changes.empty()) {
+            return;
+         }
+         batch.assign(changes.begin(), changes.end());
+         changes.clear();
+      }
+      std::vector<bool> applied(batch.size(), true);
+      unsigned long version = network.update([&batch, &applied](Graph<int> & graph) {
+         for (std::size_t index = 0; index < batch.size(); index++) {
+            const Change & change = batch[index];
+            Vertex<int> from(change.from);
+            Vertex<int> to(change.to);
+            if (!change.open) {
+               applied[index] = graph.removeEdge(EUndirected, from, to);
+            } else if (!graph.updateWeight(EUndirected, from, to, change.height)) {
+               graph.createVertex(change.from);
+               graph.createVertex(change.to);
+               graph.addUndirectedEdge(from, to, change.height);
+            }
+         }
+      });
+      for (std::size_t index = 0; index < batch.size(); index++) {
+         const Change & change = batch[index];
+         reply(*change.connection, change.sequence, applied[index] ? "ok version " + std::to_string(version)
+               : "none " + std::to_string(change.from) + ' ' + std::to_string(change.to));
+      }
+   }
+}
+
+/*
+ Adds the response, and the responses after it that were already waiting, to the outgoing
+ responses if all the earlier responses of the connection have been added. Does not write
+ to the socket, only wakes the thread of the connection, so it never blocks.
+ */
+inline void RouteServer::reply(Connection & connection, unsigned long sequence, std::string response) {
+   bool added = false;
+   {
+      std::lock_guard<std::mutex> guard(connection.mutex);
+      response += '\n';
+      connection.ready.emplace(sequence, std::move(response));
+      for (auto next = connection.ready.find(connection.nextToWrite); next != connection.ready.end();
+           next = connection.ready.find(connection.nextToWrite)) {
+         if (!connection.broken) {
+            connection.outgoing += next->second;
+         }
+         connection.ready.erase(next);
+         connection.nextToWrite++;
+         added = true;
+      }
+   }
+   // The pipe is non-blocking; if it is full, the thread is already going to wake up.
+   if (added) {
+      char wake = 1;
+      [[maybe_unused]] ssize_t count = write(connection.wake[1], &wake, 1);
+   }
+}
+
+inline bool RouteServer::send(Connection & connection, std::string & sending) {
+   std::size_t written = 0;
+   while (written < sending.size()) {
+      ssize_t count = write(connection.socket, sending.data() + written, sending.size() - written);
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+         break;
+      }
+      if (count < 0 && errno == EINTR) {
+         continue;
+      }
+      if (count <= 0) {
+         return false;
+      }
+      written += count;
+   }
+   sending.erase(0, written);
+   return true;
+}
+
+inline void RouteServer::recordLatency(double microseconds) {
+   std::lock_guard<std::mutex> guard(latencyMutex);
+   latencies[latencyCount % latencies.size()] = microseconds;
+   latencyCount++;
+}
+
+/*
+ Percentiles are calculated from the latest latencies kept in the ring buffer.
+ */
+inline std::string RouteServer::statistics() {
+   std::size_t queueDepth;
+   std::size_t maxDepth;
+   {
+      std::lock_guard<std::mutex> guard(jobsMutex);
+      queueDepth = jobs.size();
+      maxDepth = maxQueueDepth;
+   }
+   std::vector<double> sorted;
+   unsigned long count;
+   {
+      std::lock_guard<std::mutex> guard(latencyMutex);
+      count = latencyCount;
+      sorted.assign(latencies.begin(), latencies.begin() + std::min(latencyCount, latencies.size()));
+   }
+   std::sort(sorted.begin(), sorted.end());
+   auto percentile = [&sorted](double fraction) -> long {
+      if (sorted.empty()) {
+         return 0;
+      }
+      return static_cast<long>(sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))]);
+   };
+   std::ostringstream result;
+   result << "stats queue_depth=" << queueDepth << " max_queue_depth=" << maxDepth
+          << " served=" << count << " p50_us=" << percentile(0.5) << " p90_us=" << percentile(0.9)
+          << " p99_us=" << percentile(0.99) << " max_us=" << percentile(1.0) << " timed_out=" << timedOut << " version=" << network.versionNumber();
+   return result.str();
+}
+
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+#endif /* RouteServer_hpp */
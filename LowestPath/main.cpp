@@ -11,36 +11,89 @@
 #include <clocale>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
 
 #include "Graph.hpp"
 #include "Dijkstra.hpp"
 #include "Prim.hpp"
+#include "GraphFile.hpp"
+#include "RouteQuery.hpp"
+#include "RouteServer.hpp"
 
 /* C++/STL implementation of the course exercise work project. The
    goal is to find a path in a network of cities where the height of
    the road is the lowest compared to other routes.
 
-   The implementation is not the fastest one and sometimes does not find
-   the expected path, but another one.
+   The search minimizes the highest edge on the route. Among the routes
+   with the same highest edge, the one found is not necessarily the shortest.
  */
 
 // Helper funcs
-bool createNetwork(const std::string & filePath, Graph<int> & network);
+bool createNetwork(const std::string & filePath, Graph<int> & network, int threads);
 void printVertices(const std::vector<Vertex<int>> & vertices);
 void printPath(const std::vector<Edge<int>> & path);
-void printPaths(const std::map<Vertex<int>, Visit<int>> & paths);
+void printPath(const ShortestPathTree<int> & paths, const Vertex<int> & target);
+int runBatch(const std::string & filePath, const std::string & queriesPath, int threads);
+int runServer(const std::string & filePath, const std::string & socketPath, int threads, long budgetMilliseconds);
 
 int targetCity = 0;
 int startCity = 1;
 
 int main(int argc, const char * argv[]) {
 
-   if (argc != 2) {
+   std::string tracePath;
+   std::string batchPath;
+   std::string socketPath;
+   int threads = static_cast<int>(std::thread::hardware_concurrency());
+   long budgetMilliseconds = 0;
+   bool validArguments = argc >= 2 && argc % 2 == 0;
+   for (int arg = 2; validArguments && arg + 1 < argc; arg += 2) {
+      std::string option(argv[arg]);
+      if (option == "--trace") {
+         tracePath = argv[arg + 1];
+      } else if (option == "--batch") {
+         batchPath = argv[arg + 1];
+      } else if (option == "--serve") {
+         socketPath = argv[arg + 1];
+      } else if (option == "--threads") {
+         threads = std::atoi(argv[arg + 1]);
+      } else if (option == "--budget") {
+         budgetMilliseconds = std::atol(argv[arg + 1]);
+      } else {
+         validArguments = false;
+      }
+   }
+   if (!validArguments) {
       std::cout << "Must give the route file name as parameter!" << std::endl;
       std::cout << "Example: " << std::endl;
-      std::cout << "lowestpath path_to_file/graph_ADS2018_20.txt" << std::endl;
+      std::cout << "lowestpath path_to_file/graph_ADS2018_20.txt [--trace trace.json]" << std::endl;
+      std::cout << "lowestpath path_to_file/graph_ADS2018_20.txt --batch queries.txt [--threads n]" << std::endl;
+      std::cout << "lowestpath path_to_file/graph_ADS2018_20.txt --serve /tmp/lowestpath.sock [--threads n] [--budget ms]" << std::endl;
+      std::cout << "File can be in the text format or in the binary format made by graphgenerator." << std::endl;
+      std::cout << "With --trace, the time spent in each phase is written to a Chrome trace file." << std::endl;
+      std::cout << "With --batch, each line of the queries file (- for standard input) has a start and a target city." << std::endl;
+      std::cout << "Answers are printed as tab separated lines, one per query." << std::endl;
+      std::cout << "With --serve, the graph is kept in memory and queries are answered from the UNIX socket." << std::endl;
+      std::cout << "With --budget, queries not answered in the given milliseconds are stopped and answered with timeout." << std::endl;
       return EXIT_FAILURE;
    }
+   if (!tracePath.empty()) {
+#ifdef GRAPH_TRACE
+      Tracer::start(tracePath);
+#else
+      std::cerr << "Tracing is not compiled in, build with -DGRAPH_TRACE=ON" << std::endl;
+#endif
+   }
+   if (!batchPath.empty()) {
+      return runBatch(argv[1], batchPath, threads);
+   }
+   if (!socketPath.empty()) {
+      return runServer(argv[1], socketPath, threads, budgetMilliseconds);
+   }
    std::cout << std::endl << " >>>> Welcome to find the lowest route between cities! >>>>" << std::endl;
    /// Create the graph using an adjacency list as an implementation.
 
@@ -51,36 +104,135 @@ int main(int argc, const char * argv[]) {
    /// Fill the network with vertices and edges.
    const std::string filePath = std::string(argv[1]);
    std::cout << " --- Using file " << filePath << std::endl;
-   if (!createNetwork(filePath, network)) {
-      std::cout << "Could not read the data file!" << std::endl;
-      return EXIT_FAILURE;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: read graph");
+      if (!createNetwork(filePath, network, threads)) {
+         std::cout << "Could not read the data file!" << std::endl;
+         return EXIT_FAILURE;
+      }
    }
 
    std::cout << " --- Using Dijkstra's algorithm to path with lowest height between cities..." << std::endl << std::endl;
    Dijkstra<int> dijkstra(network);
-   auto pathsFromStart = dijkstra.lowestPathsFrom(Vertex<int>(startCity));
-   auto path = dijkstra.shortestPathTo(Vertex<int>(targetCity), pathsFromStart);
-   printPath(path);
+   AlgorithmStats stats;
+   std::shared_ptr<const ShortestPathTree<int>> pathsFromStart;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: search");
+      pathsFromStart = dijkstra.lowestPathTreeFrom(Vertex<int>(startCity), stats);
+   }
+   {
+      GRAPH_TRACE_SPAN("lowestpath: print path");
+      printPath(*pathsFromStart, Vertex<int>(targetCity));
+   }
+#ifdef GRAPH_STATS
+   std::cout << " Search stats: " << stats << std::endl;
+#endif
 
-   std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-   std::chrono::milliseconds timeValue = std::chrono::duration_cast<std::chrono::milliseconds>(now-started);
-   std::cout << " Finding the route took " << timeValue.count() << " ms" << std::endl;
+   // With tracing the phases are timed separately in the trace file, written at exit.
+   if (tracePath.empty() || !Tracer::isEnabled()) {
+      std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+      std::chrono::milliseconds timeValue = std::chrono::duration_cast<std::chrono::milliseconds>(now-started);
+      std::cout << " Finding the route took " << timeValue.count() << " ms" << std::endl;
+   } else {
+      std::cout << " Trace of the phases is written to " << tracePath << std::endl;
+   }
 
    std::cout << std::endl << "<<<< Thank you for using lowestroute! <<<<" << std::endl << std::endl;
    return EXIT_SUCCESS;
 }
 
 
-bool createNetwork(const std::string & filePath, Graph<int> & network) {
+/*
+ Batch mode loads the graph once and answers all the queries with a pool of threads.
+ Only the answers go to the standard output, the progress is printed to standard error.
+ */
+int runBatch(const std::string & filePath, const std::string & queriesPath, int threads) {
+   Graph<int> network;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: read graph");
+      if (!createNetwork(filePath, network, threads)) {
+         std::cerr << "Could not read the data file!" << std::endl;
+         return EXIT_FAILURE;
+      }
+   }
+   std::vector<RouteQuery> queries;
+   int errorLine = 0;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: read queries");
+      std::ifstream file;
+      if (queriesPath != "-") {
+         file.open(queriesPath);
+         if (!file) {
+            std::cerr << "Could not open the queries file " << queriesPath << std::endl;
+            return EXIT_FAILURE;
+         }
+      }
+      if (!readQueries(queriesPath == "-" ? std::cin : file, queries, errorLine)) {
+         std::cerr << "Invalid query on line " << errorLine << " of " << queriesPath << std::endl;
+         return EXIT_FAILURE;
+      }
+   }
+   // Each start is searched once in the batch, so keeping the paths in the cache is no use.
+   network.pathCache.setCapacity(0);
+   Dijkstra<int> dijkstra(network);
+   auto started = std::chrono::steady_clock::now();
+   std::vector<RouteAnswer> answers;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: answer queries");
+      answers = answerQueries(dijkstra, queries, std::max(1, threads));
+   }
+   std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+   {
+      GRAPH_TRACE_SPAN("lowestpath: write answers");
+      writeAnswers(std::cout, answers);
+      std::cout.flush();
+   }
+   std::cerr << "Answered " << answers.size() << " queries in " << elapsed.count() << " ms" << std::endl;
+   return std::cout ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ Server mode keeps the graph loaded and answers the queries sent to the socket until
+ a client sends shutdown or the process is interrupted.
+ */
+int runServer(const std::string & filePath, const std::string & socketPath, int threads, long budgetMilliseconds) {
+#if defined(__unix__) || defined(__APPLE__)
+   Graph<int> network;
+   if (!createNetwork(filePath, network, threads)) {
+      std::cerr << "Could not read the data file!" << std::endl;
+      return EXIT_FAILURE;
+   }
+   std::cerr << "Serving " << network.adjacencies.size() << " cities at " << socketPath << std::endl;
+   VersionedGraph<int> versions(std::move(network));
+   RouteServer server(versions, std::max(1, threads), std::chrono::milliseconds(budgetMilliseconds));
+   if (!server.run(socketPath)) {
+      std::cerr << "Could not listen to " << socketPath << ": " << std::strerror(errno) << std::endl;
+      return EXIT_FAILURE;
+   }
+   std::cerr << "Server stopped" << std::endl;
+   return EXIT_SUCCESS;
+#else
+   std::cerr << "Server mode needs UNIX domain sockets, not available on this platform" << std::endl;
+   return EXIT_FAILURE;
+#endif
+}
+
+bool createNetwork(const std::string & filePath, Graph<int> & network, int threads) {
    bool done = false;
    try {
-      std::ifstream file(filePath);
+      std::ifstream file(filePath, std::ios::binary);
+      // Files made with the graph generator may also be in the binary format.
+      if (GraphFile::isBinary(file)) {
+         return GraphFile::readBinary(file, network, targetCity, threads);
+      }
       int currentLine = 0;
       int linesToRead = 0;
       std::string line;
       int inLine = 0;
       int citiesInFile = 0;
       int edgesInFile = 0;
+      // Edges are collected and the graph is built from them at once.
+      std::vector<Edge<int>> edges;
       while (std::getline(file, line))
       {
          std::istringstream iss(line);
@@ -96,9 +248,7 @@ bool createNetwork(const std::string & filePath, Graph<int> & network) {
             if (!(iss >> city1 >> city2 >> weight)) {
                break;
             }
-            auto vCity1 = network.createVertex(city1);
-            auto vCity2 = network.createVertex(city2);
-            network.addUndirectedEdge(vCity1, vCity2, weight);
+            edges.emplace_back(Vertex<int>(city1), Vertex<int>(city2), weight);
             inLine++;
          } else {
             // last line
@@ -109,6 +259,7 @@ bool createNetwork(const std::string & filePath, Graph<int> & network) {
          }
       }
       file.close();
+      network.buildFrom(edges, EUndirected, threads);
    } catch (std::exception & e) {
       std::cout << "Could not open file: " << e.what() << std::endl;
       return false;
@@ -141,48 +292,22 @@ void printPath(const std::vector<Edge<int>> & path) {
    std::cout << std::setw(20) << ">> Totalling: " << std::setw(5) << total << " metres" << std::endl << std::endl;
 }
 
-void printPaths(const std::map<Vertex<int>, Visit<int>> & paths) {
-   // Visits arranged by city operator < so based on city name.
-   // We wish to print starting visit first, then other so let's do that.
-   // Using tempPath since it is easier to erase paths as we print them and
-   // concentrate on those paths not yet printed.
-   auto tempPath = paths;
-
-   // Printing out paths in some sensible order until all are handled and tempPath is empty.
-   Vertex<int> city;
-   std::queue<Vertex<int>> nextcities;
-   while (!tempPath.empty()) {
-      bool startFound = false;
-      auto iterator = tempPath.begin();
-      // First print the starting edge, and remove it from map when done.
-      while (!startFound && iterator != tempPath.end()) {
-         if (iterator->second.type == VisitType::EStart) {
-            city = iterator->first;
-            std::cout << "Starting from: " << city << std::endl;
-            tempPath.erase(iterator);
-            nextcities.push(city);
-            startFound = true;
-            break; // (iterator != paths.end())
-         }
-         iterator++;
-      }
-      // Then print edges in order and remove them when done. Only Edges here so no need to check visit type.
-      while (!nextcities.empty()) {
-         city = nextcities.front();
-         nextcities.pop();
-         iterator = tempPath.begin();
-         while (iterator != tempPath.end()) {
-            if (iterator->second.edge.source == city) {
-               std::cout << " Edge " << iterator->second.edge.source << "-> " << iterator->second.edge.destination;
-               std::cout << " " << iterator->second.edge.weight << " km." << std::endl;
-               nextcities.push(iterator->second.edge.destination);
-               tempPath.erase(iterator);
-               iterator = tempPath.begin();
-            } else {
-               iterator++;
-            }
-         }
+void printPath(const ShortestPathTree<int> & paths, const Vertex<int> & target) {
+   // Route has the vertex indices in order from start to the target.
+   std::vector<int> route;
+   paths.routeTo(target, route);
+   double total = 0.0;
+   double max = -1.0;
+   for (std::size_t step = 1; step < route.size(); step++) {
+      double weight = paths.weightTo(route[step]);
+      std::wcout << std::right << std::setw(10) << paths.vertexAt(route[step - 1]).data << std::setw(6) << " --> ";
+      std::wcout << std::left << std::setw(10) << paths.vertexAt(route[step]).data;
+      std::wcout << " : " << weight << "m" << std::endl;
+      total += weight;
+      if (weight > max) {
+         max = weight;
       }
    }
-   std::cout << std::endl;
+   std::cout << std::setw(20) << ">> Max height: " << std::setw(5) << max << " metres" << std::endl;
+   std::cout << std::setw(20) << ">> Totalling: " << std::setw(5) << total << " metres" << std::endl << std::endl;
 }
@@ -0,0 +1,560 @@
+#ifndef MappedGraph_hpp
+#define MappedGraph_hpp
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <string>
+#include <cstdio>     // std::remove
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+#include <sys/mman.h> // memory mapping the file
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "GraphFile.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// How the algorithms are going to read the edges of a MappedGraph, told to the operating
+/// system so it can read the file ahead or not.
+enum MappedAccess {
+   ENormalAccess,       // Some read ahead, for edges read mostly near each other
+   ESequentialAccess,   // Edges read from start to end, read far ahead and drop the pages behind
+   ERandomAccess        // Edges read in no order, no read ahead
+};
+
+/**
+ A read only graph kept in a memory mapped file, for graphs too large to fit in memory.
+
+ The vertices are numbered from 0 to vertexCount() - 1 and the edges of a vertex are
+ firstEdge(number)...firstEdge(number + 1) - 1. The operating system reads the parts of the
+ file the algorithms use and drops them when memory is needed, so only the state the
+ algorithms keep for each vertex, in MappedSearch, needs to fit in memory.
+
+ The file is made with write() from a CompactGraph or CompressedGraph numbering the vertices,
+ or with convert() from a GraphFile binary graph without reading the whole graph into memory.
+ The file is in native byte order:
+  - 8 bytes "GRPHMAPD", uint32 format version (1), int32 vertex count, int64 edge count
+  - int64 offset of the first edge of each vertex, and the edge count as the last one
+  - int32 destination of each edge
+  - 64 bit double weight of each edge, starting at the next multiple of 8 bytes.
+ Destinations and weights are kept apart, so the searches not needing the weights read only
+ a third of the edge data.
+
+ Uses the POSIX mmap(), so it is available only on UNIX-like systems. The space of a file
+ being written is allocated with posix_fallocate(), or on macOS, which does not have it,
+ with ftruncate(), where a full disk shows only when the mapped pages are written.
+ */
+class MappedGraph {
+public:
+   MappedGraph();
+   ~MappedGraph();
+   MappedGraph(const MappedGraph &) = delete;
+   const MappedGraph & operator = (const MappedGraph &) = delete;
+
+   /// Maps the graph file for reading. Returns false if the file is not a valid graph file.
+   /// Reads the offsets and the destinations once to check that they are in range, so the
+   /// searches can trust them.
+   bool open(const std::string & path);
+   /// Unmaps the file.
+   void close();
+   /// Is a file mapped.
+   bool isOpen() const;
+
+   /// Number of vertices.
+   int vertexCount() const;
+   /// Number of edges.
+   std::int64_t edgeCount() const;
+   /// Index of the first edge of the vertex with the number. firstEdge(vertexCount()) is edgeCount().
+   std::int64_t firstEdge(int number) const;
+   /// Number of the destination of the edge.
+   int destination(std::int64_t edge) const;
+   /// Weight of the edge.
+   double weight(std::int64_t edge) const;
+   /// Tells the operating system how the edges are going to be read.
+   void advise(MappedAccess access) const;
+
+   /// Writes the graph to the file, numbered as in the graph. Graph is a CompactGraph or any
+   /// graph with the same vertexCount(), edgeCount() and edges() functions.
+   template <typename Compact>
+   static bool write(const Compact & graph, const std::string & path);
+   /// Writes the GraphFile binary graph in the stream to the file, vertex v as number v - 1.
+   /// Only the edge offsets are kept in memory: the stream is read once to count the edges of
+   /// each vertex, and once more for each windowBytes of the file to write the edges.
+   /// The stream must be seekable. Duplicate edges are kept, so the shortest paths use the
+   /// lightest of them, where a Graph keeps the first one added.
+   static bool convert(std::istream & stream, const std::string & path, std::size_t windowBytes = std::size_t(1) << 30);
+
+private:
+   /// Creates the file for the graph and maps it for writing.
+   bool create(const std::string & path, int vertexCount, std::int64_t edgeCount);
+   /// Maps the file, setting the pointers to its parts. Returns false if the file is not valid.
+   bool map(int descriptor, bool writable);
+   /// Are the offsets increasing from 0 to the edge count, and the destinations vertex numbers.
+   bool edgesValid() const;
+   /// Size of the file, and where the destinations and weights start in it.
+   static std::size_t layout(int vertexCount, std::int64_t edgeCount, std::size_t & destinationsAt, std::size_t & weightsAt);
+   /// Reads the edges of a binary graph in parts, calling the work for each.
+   /// Returns false if the stream ends early or the work returns false.
+   static bool forEachEdge(std::istream & stream, std::int64_t edgeCount, const std::function<bool(const GeneratedEdge &)> & work);
+
+   static constexpr char magic[8] = {'G', 'R', 'P', 'H', 'M', 'A', 'P', 'D'};
+   static constexpr std::uint32_t formatVersion = 1;
+   static constexpr std::size_t headerSize = 24;
+
+   char * data;
+   std::size_t size;
+   int vertices;
+   std::int64_t edges;
+   std::int64_t * offsets;
+   std::int32_t * destinations;
+   double * weights;
+};
+
+/// Shortest paths found by MappedSearch, indexed by the vertex numbers.
+struct MappedPaths {
+   std::vector<double> distances;   // Infinity if the vertex was not reached.
+   std::vector<int> parents;        // Previous vertex on the path, -1 for the start and the vertices not reached.
+};
+
+/// Searches on a MappedGraph, keeping only arrays of the vertices in memory and
+/// reading the edges in an order that lets the operating system read the file ahead.
+class MappedSearch {
+public:
+   /// Number of edges from the start to each vertex, -1 if the vertex cannot be reached.
+   /// The vertices of each level are handled in the order of their numbers, so the edges
+   /// are read from the file in order, once per level.
+   static std::vector<int> breadthFirstLevels(const MappedGraph & graph, int start);
+   /// Component number of each vertex, components numbered in the order of their smallest
+   /// vertex. Edges are followed in both directions, so directed graphs give weakly connected
+   /// components. Reads the edges once from start to end.
+   static std::vector<int> connectedComponents(const MappedGraph & graph);
+   /// Shortest paths from the start to all the vertices with Dijkstra's algorithm. The edges
+   /// are read in the order the vertices are settled, which is near each other in the file
+   /// when the vertices are numbered with ECuthillMcKeeOrder before writing the graph.
+   static MappedPaths shortestPathsFrom(const MappedGraph & graph, int start);
+   static MappedPaths shortestPathsFrom(const MappedGraph & graph, int start, AlgorithmStats & stats);
+
+private:
+   static MappedPaths search(const MappedGraph & graph, int start, AlgorithmStats * stats);
+   /// Root of the set of the vertex, halving the path to it.
+   static int rootOf(std::vector<int> & parents, int number);
+};
+
+
+inline MappedGraph::MappedGraph()
+: data(nullptr), size(0), vertices(0), edges(0), offsets(nullptr), destinations(nullptr), weights(nullptr) {
+}
+
+inline MappedGraph::~MappedGraph() {
+   close();
+}
+
+inline bool MappedGraph::open(const std::string & path) {
+   close();
+   int descriptor = ::open(path.c_str(), O_RDONLY);
+   if (descriptor < 0) {
+      return false;
+   }
+   bool mapped = map(descriptor, false);
+   ::close(descriptor);
+   if (mapped && !edgesValid()) {
+      close();
+      return false;
+   }
+   return mapped;
+}
+
+inline void MappedGraph::close() {
+   if (data != nullptr) {
+      munmap(data, size);
+   }
+   data = nullptr;
+   size = 0;
+   vertices = 0;
+   edges = 0;
+   offsets = nullptr;
+   destinations = nullptr;
+   weights = nullptr;
+}
+
+inline bool MappedGraph::isOpen() const {
+   return data != nullptr;
+}
+
+inline int MappedGraph::vertexCount() const {
+   return vertices;
+}
+
+inline std::int64_t MappedGraph::edgeCount() const {
+   return edges;
+}
+
+inline std::int64_t MappedGraph::firstEdge(int number) const {
+   return offsets[number];
+}
+
+inline int MappedGraph::destination(std::int64_t edge) const {
+   return destinations[edge];
+}
+
+inline double MappedGraph::weight(std::int64_t edge) const {
+   return weights[edge];
+}
+
+inline void MappedGraph::advise(MappedAccess access) const {
+   if (data != nullptr) {
+      int advice = access == ESequentialAccess ? MADV_SEQUENTIAL : access == ERandomAccess ? MADV_RANDOM : MADV_NORMAL;
+      madvise(data, size, advice);
+   }
+}
+
+/*
+ The header is written last, so a file left incomplete is not a valid graph.
+ */
+template <typename Compact>
+bool MappedGraph::write(const Compact & graph, const std::string & path) {
+   GRAPH_TRACE_SPAN("MappedGraph::write");
+   MappedGraph output;
+   if (!output.create(path, graph.vertexCount(), graph.edgeCount())) {
+      return false;
+   }
+   std::int64_t edge = 0;
+   for (int number = 0; number < graph.vertexCount(); number++) {
+      output.offsets[number] = edge;
+      for (const auto & compactEdge : graph.edges(number)) {
+         output.destinations[edge] = compactEdge.destination;
+         output.weights[edge] = compactEdge.weight;
+         edge++;
+      }
+   }
+   output.offsets[graph.vertexCount()] = edge;
+   std::memcpy(output.data, magic, sizeof(magic));
+   output.close();
+   return true;
+}
+
+/*
+ The edges of each vertex are placed at a cursor starting from the vertex's offset.
+ The file is written in windows of consecutive vertices, so the pages written in a pass
+ are near each other and can be written back to the disk in order.
+ */
+inline bool MappedGraph::convert(std::istream & stream, const std::string & path, std::size_t windowBytes) {
+   GRAPH_TRACE_SPAN("MappedGraph::convert");
+   int vertexCount = 0;
+   std::int64_t edgeCount = 0;
+   int target = 0;
+   EdgeType type = EUndirected;
+   if (!GraphFile::readBinaryHeader(stream, vertexCount, edgeCount, target, type) || vertexCount < 0) {
+      return false;
+   }
+   const auto edgesAt = stream.tellg();
+   std::vector<std::int64_t> cursors(static_cast<std::size_t>(vertexCount) + 1, 0);
+   bool counted = forEachEdge(stream, edgeCount, [&](const GeneratedEdge & edge) {
+      if (edge.source < 1 || edge.source > vertexCount || edge.destination < 1 || edge.destination > vertexCount) {
+         return false;
+      }
+      cursors[edge.source]++;
+      if (type == EUndirected) {
+         cursors[edge.destination]++;
+      }
+      return true;
+   });
+   if (!counted) {
+      return false;
+   }
+   for (int number = 0; number < vertexCount; number++) {
+      cursors[number + 1] += cursors[number];
+   }
+   MappedGraph output;
+   if (!output.create(path, vertexCount, cursors[vertexCount])) {
+      return false;
+   }
+   std::copy(cursors.begin(), cursors.end(), output.offsets);
+   const std::int64_t windowEdges = std::max<std::int64_t>(1, windowBytes / (sizeof(std::int32_t) + sizeof(double)));
+   int first = 0;
+   while (first < vertexCount) {
+      int last = first + 1;
+      while (last < vertexCount && output.offsets[last + 1] - output.offsets[first] <= windowEdges) {
+         last++;
+      }
+      auto place = [&output, &cursors, first, last](int number, int destination, double weight) {
+         if (number >= first && number < last) {
+            std::int64_t edge = cursors[number]++;
+            output.destinations[edge] = destination;
+            output.weights[edge] = weight;
+         }
+      };
+      stream.clear();
+      stream.seekg(edgesAt);
+      bool placed = forEachEdge(stream, edgeCount, [&](const GeneratedEdge & edge) {
+         place(edge.source - 1, edge.destination - 1, edge.weight);
+         if (type == EUndirected) {
+            place(edge.destination - 1, edge.source - 1, edge.weight);
+         }
+         return true;
+      });
+      if (!placed) {
+         output.close();
+         std::remove(path.c_str());
+         return false;
+      }
+      first = last;
+   }
+   std::memcpy(output.data, magic, sizeof(magic));
+   output.close();
+   return true;
+}
+
+/*
+ The space is allocated on the disk up front, so a full disk is an error here
+ and not a crash when the mapped pages are written.
+ */
+inline bool MappedGraph::create(const std::string & path, int vertexCount, std::int64_t edgeCount) {
+   close();
+   std::size_t destinationsAt = 0;
+   std::size_t weightsAt = 0;
+   std::size_t fileSize = layout(vertexCount, edgeCount, destinationsAt, weightsAt);
+   int descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+   if (descriptor < 0) {
+      return false;
+   }
+   char header[headerSize] = {0};
+   std::memcpy(header + sizeof(magic), &formatVersion, sizeof(formatVersion));
+   std::memcpy(header + sizeof(magic) + sizeof(formatVersion), &vertexCount, sizeof(vertexCount));
+   std::memcpy(header + sizeof(magic) + sizeof(formatVersion) + sizeof(vertexCount), &edgeCount, sizeof(edgeCount));
+#if defined(__APPLE__)
+   bool reserved = ftruncate(descriptor, static_cast<off_t>(fileSize)) == 0;
+#else
+   bool reserved = posix_fallocate(descriptor, 0, static_cast<off_t>(fileSize)) == 0;
+#endif
+   bool created = reserved &&
+                  pwrite(descriptor, header, headerSize, 0) == static_cast<ssize_t>(headerSize) &&
+                  map(descriptor, true);
+   ::close(descriptor);
+   if (!created) {
+      std::remove(path.c_str());
+   }
+   return created;
+}
+
+/*
+ A file being written has zeros for the magic, so the magic is checked only when reading.
+ */
+inline bool MappedGraph::map(int descriptor, bool writable) {
+   struct stat status;
+   if (fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < headerSize) {
+      return false;
+   }
+   std::size_t fileSize = static_cast<std::size_t>(status.st_size);
+   void * mapped = mmap(nullptr, fileSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0);
+   if (mapped == MAP_FAILED) {
+      return false;
+   }
+   char * bytes = static_cast<char *>(mapped);
+   std::uint32_t version = 0;
+   std::int32_t vertexCount = 0;
+   std::int64_t edgeCount = 0;
+   std::memcpy(&version, bytes + sizeof(magic), sizeof(version));
+   std::memcpy(&vertexCount, bytes + sizeof(magic) + sizeof(version), sizeof(vertexCount));
+   std::memcpy(&edgeCount, bytes + sizeof(magic) + sizeof(version) + sizeof(vertexCount), sizeof(edgeCount));
+   std::size_t destinationsAt = 0;
+   std::size_t weightsAt = 0;
+   bool valid = (writable || std::memcmp(bytes, magic, sizeof(magic)) == 0) && version == formatVersion &&
+                vertexCount >= 0 && edgeCount >= 0 &&
+                layout(vertexCount, edgeCount, destinationsAt, weightsAt) == fileSize;
+   if (!valid) {
+      munmap(mapped, fileSize);
+      return false;
+   }
+   data = bytes;
+   size = fileSize;
+   vertices = vertexCount;
+   edges = edgeCount;
+   offsets = reinterpret_cast<std::int64_t *>(bytes + headerSize);
+   destinations = reinterpret_cast<std::int32_t *>(bytes + destinationsAt);
+   weights = reinterpret_cast<double *>(bytes + weightsAt);
+   return true;
+}
+
+/*
+ The offsets and the destinations are read in order, so the operating system can read
+ the file ahead. The weights are not checked, since any double is a weight.
+ */
+inline bool MappedGraph::edgesValid() const {
+   advise(ESequentialAccess);
+   bool valid = offsets[0] == 0 && offsets[vertices] == edges;
+   for (int number = 0; valid && number < vertices; number++) {
+      valid = offsets[number] <= offsets[number + 1];
+   }
+   for (std::int64_t edge = 0; valid && edge < edges; edge++) {
+      valid = destinations[edge] >= 0 && destinations[edge] < vertices;
+   }
+   advise(ENormalAccess);
+   return valid;
+}
+
+inline std::size_t MappedGraph::layout(int vertexCount, std::int64_t edgeCount, std::size_t & destinationsAt, std::size_t & weightsAt) {
+   destinationsAt = headerSize + (static_cast<std::size_t>(vertexCount) + 1) * sizeof(std::int64_t);
+   weightsAt = destinationsAt + static_cast<std::size_t>(edgeCount) * sizeof(std::int32_t);
+   weightsAt = (weightsAt + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+   return weightsAt + static_cast<std::size_t>(edgeCount) * sizeof(double);
+}
+
+inline bool MappedGraph::forEachEdge(std::istream & stream, std::int64_t edgeCount, const std::function<bool(const GeneratedEdge &)> & work) {
+   std::vector<GeneratedEdge> part;
+   std::int64_t remaining = edgeCount;
+   while (remaining > 0) {
+      std::size_t records = static_cast<std::size_t>(std::min<std::int64_t>(remaining, 65536));
+      part.clear();
+      if (!GraphFile::readBinaryEdges(stream, records, part)) {
+         return false;
+      }
+      for (const auto & edge : part) {
+         if (!work(edge)) {
+            return false;
+         }
+      }
+      remaining -= records;
+   }
+   return true;
+}
+
+/*
+ Level by level breadth first search. Sorting the next level costs little
+ compared to reading the edges all over the file.
+ */
+inline std::vector<int> MappedSearch::breadthFirstLevels(const MappedGraph & graph, int start) {
+   GRAPH_TRACE_SPAN("MappedSearch::breadthFirstLevels");
+   std::vector<int> levels(graph.vertexCount(), -1);
+   if (start < 0 || start >= graph.vertexCount()) {
+      return levels;
+   }
+   graph.advise(ENormalAccess);
+   std::vector<int> level{start};
+   std::vector<int> next;
+   levels[start] = 0;
+   for (int depth = 1; !level.empty(); depth++) {
+      next.clear();
+      for (int number : level) {
+         for (std::int64_t edge = graph.firstEdge(number); edge < graph.firstEdge(number + 1); edge++) {
+            int destination = graph.destination(edge);
+            if (levels[destination] < 0) {
+               levels[destination] = depth;
+               next.push_back(destination);
+            }
+         }
+      }
+      std::sort(next.begin(), next.end());
+      level.swap(next);
+   }
+   return levels;
+}
+
+/*
+ Union-find over the edges: the root of each set is its smallest vertex,
+ so the roots are met in order when numbering the components.
+ */
+inline std::vector<int> MappedSearch::connectedComponents(const MappedGraph & graph) {
+   GRAPH_TRACE_SPAN("MappedSearch::connectedComponents");
+   const int count = graph.vertexCount();
+   std::vector<int> parents(count);
+   for (int number = 0; number < count; number++) {
+      parents[number] = number;
+   }
+   graph.advise(ESequentialAccess);
+   for (int number = 0; number < count; number++) {
+      for (std::int64_t edge = graph.firstEdge(number); edge < graph.firstEdge(number + 1); edge++) {
+         int root = rootOf(parents, number);
+         int another = rootOf(parents, graph.destination(edge));
+         if (root != another) {
+            parents[std::max(root, another)] = std::min(root, another);
+         }
+      }
+   }
+   std::vector<int> components(count, -1);
+   int componentCount = 0;
+   for (int number = 0; number < count; number++) {
+      int root = rootOf(parents, number);
+      components[number] = root == number ? componentCount++ : components[root];
+   }
+   graph.advise(ENormalAccess);
+   return components;
+}
+
+inline MappedPaths MappedSearch::shortestPathsFrom(const MappedGraph & graph, int start) {
+   return search(graph, start, nullptr);
+}
+
+inline MappedPaths MappedSearch::shortestPathsFrom(const MappedGraph & graph, int start, AlgorithmStats & stats) {
+   return search(graph, start, &stats);
+}
+
+/*
+ Same as CompactSearch::shortestPathTreeFrom, the paths are left in the arrays.
+ */
+inline MappedPaths MappedSearch::search(const MappedGraph & graph, int start, AlgorithmStats * stats) {
+   GRAPH_TRACE_SPAN("MappedSearch::shortestPathsFrom");
+   StatsTimer timer(stats);
+   typedef std::pair<double, int> QueueElement;
+   const int count = graph.vertexCount();
+   MappedPaths paths{std::vector<double>(count, std::numeric_limits<double>::infinity()), std::vector<int>(count, -1)};
+   if (start < 0 || start >= count) {
+      return paths;
+   }
+   graph.advise(ENormalAccess);
+   std::vector<bool> settled(count, false);
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> priorityQueue;
+   paths.distances[start] = 0.0;
+   priorityQueue.push(QueueElement(0.0, start));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   GrowthCounter queueGrowth(stats);
+   queueGrowth.sizeIs(priorityQueue.size());
+   while (!priorityQueue.empty()) {
+      auto [distance, number] = priorityQueue.top();
+      priorityQueue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[number]) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      settled[number] = true;
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (std::int64_t edge = graph.firstEdge(number); edge < graph.firstEdge(number + 1); edge++) {
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         int destination = graph.destination(edge);
+         if (settled[destination]) {
+            continue;
+         }
+         double candidate = distance + graph.weight(edge);
+         if (candidate < paths.distances[destination]) {
+            paths.distances[destination] = candidate;
+            paths.parents[destination] = number;
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            priorityQueue.push(QueueElement(candidate, destination));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(priorityQueue.size());
+         }
+      }
+   }
+   return paths;
+}
+
+inline int MappedSearch::rootOf(std::vector<int> & parents, int number) {
+   while (parents[number] != number) {
+      parents[number] = parents[parents[number]];
+      number = parents[number];
+   }
+   return number;
+}
+
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+#endif /* MappedGraph_hpp */
@@ -0,0 +1,324 @@
+#ifndef ParetoRouting_hpp
+#define ParetoRouting_hpp
+
+#include <vector>
+#include <queue>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "Graph.hpp"
+#include "AlgorithmStats.hpp"
+#include "Cancellation.hpp"
+#include "Trace.hpp"
+
+/// A route found by ParetoRouting, with both of its costs.
+template <typename T>
+struct ParetoRoute {
+   double distance;              // Sum of the edge weights.
+   double maxWeight;             // Highest edge weight.
+   std::vector<Edge<T>> edges;   // From the start to the target.
+};
+
+/**
+ Finds the routes between two vertices that are the best trade-offs between the total
+ distance and the highest edge weight, like between Dijkstra::shortestPathsFrom and
+ Dijkstra::lowestPathsFrom. A route is on the Pareto front if no other route is at least
+ as good in both and better in one. The front is given from the lowest route (smallest
+ highest weight) to the shortest route, each later route shorter and higher than the one before.
+
+ The search keeps a label (distance, max weight) for each non-dominated partial route to each
+ vertex. Since there are only two costs, the labels of a vertex are kept as a staircase sorted by
+ the max weight, with the distances decreasing, so checking if a new label is dominated is a binary
+ search. The distance and the lowest max weight from each vertex to the target are searched
+ first, backwards from the target. A label is dropped if even these lower bounds to the target
+ cannot give a route not dominated by the routes already found, which keeps the search
+ near the routes that matter. Labels are handled in the order of the distance bound, as in A*.
+
+ Edge weights must not be negative. The graph is copied to arrays when the router is made,
+ leaving out the dangling edges, so later changes of the graph are not seen by the router.
+ */
+template <typename T>
+class ParetoRouting {
+public:
+   ParetoRouting(const Graph<T> & graph);
+
+   /// Keeps at most maxLabels labels for each vertex, 0 for no limit (the default).
+   /// When a vertex has too many labels, the one nearest to its neighbour in distance is
+   /// dropped, but never the lowest or the shortest one. This bounds the time and memory
+   /// on large graphs with many different weights, but then some routes of the front may be missed.
+   void setMaxLabelsPerVertex(std::size_t maxLabels);
+
+   /// The Pareto front of routes from start to target. Empty if the target cannot be reached.
+   std::vector<ParetoRoute<T>> routesBetween(const Vertex<T> & start, const Vertex<T> & target) const;
+   /// Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   /// Labels handled are counted as settled vertices.
+   std::vector<ParetoRoute<T>> routesBetween(const Vertex<T> & start, const Vertex<T> & target, AlgorithmStats & stats) const;
+   /// Like above, stopping when the token is cancelled or its deadline passes.
+   /// Returns no routes if stopped; check the token to know if the search was stopped.
+   std::vector<ParetoRoute<T>> routesBetween(const Vertex<T> & start, const Vertex<T> & target, const CancellationToken & token) const;
+
+private:
+   /// A partial route to a vertex.
+   struct Label {
+      int vertex;
+      int parent;          // Label of the route without the last edge, -1 for the start.
+      double distance;
+      double maxWeight;
+      double weight;       // Weight of the last edge.
+      bool alive;          // Not dominated or dropped.
+   };
+   /// Distance bound, max weight bound and the label, smallest first in the queue.
+   typedef std::tuple<double, double, int> QueueElement;
+   /// Labels of a vertex, by max weight ascending and distance descending.
+   typedef std::vector<int> Front;
+
+   std::vector<ParetoRoute<T>> search(const Vertex<T> & start, const Vertex<T> & target, AlgorithmStats * stats, const CancellationToken * token) const;
+   /// Searches the lower bounds from each vertex to the target, backwards along the edges.
+   /// Lowest gives the lowest max weights, otherwise the shortest distances.
+   bool boundsTo(int target, bool lowest, std::vector<double> & bounds, CancellationCheck & cancellation) const;
+   /// Is a label with the costs dominated by a label of the front.
+   static bool isDominated(const Front & front, const std::vector<Label> & labels, double distance, double maxWeight);
+   /// Adds the label to the front, removing the labels it dominates, and drops a label if
+   /// the front gets too large. Returns false if the label itself was dropped.
+   bool addToFront(Front & front, std::vector<Label> & labels, int label) const;
+
+   std::vector<Vertex<T>> vertices;     // Graph order.
+   std::vector<std::size_t> offsets;    // Edges of vertex v are destinations[offsets[v]...offsets[v+1]-1].
+   std::vector<int> destinations;
+   std::vector<double> weights;
+   std::vector<std::size_t> reverseOffsets;
+   std::vector<int> sources;            // Edges into each vertex, for searching backwards.
+   std::vector<double> reverseWeights;
+   std::size_t maxLabels = 0;
+};
+
+
+/*
+ Vertices are numbered in the order of the adjacencies, and the edges are put to arrays
+ in both directions.
+ */
+template <typename T>
+ParetoRouting<T>::ParetoRouting(const Graph<T> & graph) {
+   vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+   }
+   auto indexOf = [this](const Vertex<T> & vertex) {
+      auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+      return found == vertices.end() || !(*found == vertex) ? -1 : static_cast<int>(found - vertices.begin());
+   };
+   offsets.reserve(vertices.size() + 1);
+   offsets.push_back(0);
+   std::vector<std::size_t> incoming(vertices.size() + 1, 0);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = indexOf(edge.destination);
+         if (destination < 0) {
+            continue;
+         }
+         destinations.push_back(destination);
+         weights.push_back(edge.weight);
+         incoming[destination + 1]++;
+      }
+      offsets.push_back(destinations.size());
+   }
+   for (std::size_t vertex = 1; vertex < incoming.size(); vertex++) {
+      incoming[vertex] += incoming[vertex - 1];
+   }
+   reverseOffsets = incoming;
+   sources.resize(destinations.size());
+   reverseWeights.resize(destinations.size());
+   for (int source = 0; source < static_cast<int>(vertices.size()); source++) {
+      for (std::size_t edge = offsets[source]; edge < offsets[source + 1]; edge++) {
+         std::size_t position = incoming[destinations[edge]]++;
+         sources[position] = source;
+         reverseWeights[position] = weights[edge];
+      }
+   }
+}
+
+template <typename T>
+void ParetoRouting<T>::setMaxLabelsPerVertex(std::size_t maxLabels) {
+   this->maxLabels = maxLabels;
+}
+
+template <typename T>
+std::vector<ParetoRoute<T>> ParetoRouting<T>::routesBetween(const Vertex<T> & start, const Vertex<T> & target) const {
+   return search(start, target, nullptr, nullptr);
+}
+
+template <typename T>
+std::vector<ParetoRoute<T>> ParetoRouting<T>::routesBetween(const Vertex<T> & start, const Vertex<T> & target, AlgorithmStats & stats) const {
+   return search(start, target, &stats, nullptr);
+}
+
+template <typename T>
+std::vector<ParetoRoute<T>> ParetoRouting<T>::routesBetween(const Vertex<T> & start, const Vertex<T> & target, const CancellationToken & token) const {
+   return search(start, target, nullptr, &token);
+}
+
+/*
+ Labels are checked against the front of the target twice: when made, and again when
+ taken from the queue, since the front may have grown while the label waited.
+ Labels dominated at their own vertex are marked not alive and skipped when popped.
+ */
+template <typename T>
+std::vector<ParetoRoute<T>> ParetoRouting<T>::search(const Vertex<T> & start, const Vertex<T> & target, AlgorithmStats * stats, const CancellationToken * token) const {
+   GRAPH_TRACE_SPAN("ParetoRouting::routesBetween");
+   StatsTimer timer(stats);
+   std::vector<ParetoRoute<T>> routes;
+   auto startFound = std::lower_bound(vertices.begin(), vertices.end(), start);
+   auto targetFound = std::lower_bound(vertices.begin(), vertices.end(), target);
+   GRAPH_STATS_ADD(stats, lookups, 2);
+   if (startFound == vertices.end() || !(*startFound == start) || targetFound == vertices.end() || !(*targetFound == target)) {
+      return routes;
+   }
+   const int startIndex = static_cast<int>(startFound - vertices.begin());
+   const int targetIndex = static_cast<int>(targetFound - vertices.begin());
+   CancellationCheck cancellation(token);
+   std::vector<double> distanceBounds;
+   std::vector<double> weightBounds;
+   if (!boundsTo(targetIndex, false, distanceBounds, cancellation) || !boundsTo(targetIndex, true, weightBounds, cancellation)) {
+      return routes;
+   }
+   const double infinity = std::numeric_limits<double>::infinity();
+   if (distanceBounds[startIndex] == infinity) {
+      return routes;
+   }
+   std::vector<Label> labels;
+   std::vector<Front> fronts(vertices.size());
+   const Front & targetFront = fronts[targetIndex];
+   std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+   GrowthCounter queueGrowth(stats);
+   // The bounds of a label are the best its routes to the target could be.
+   auto isHopeless = [&](int vertex, double distance, double maxWeight) {
+      return isDominated(targetFront, labels, distance + distanceBounds[vertex], std::max(maxWeight, weightBounds[vertex]));
+   };
+   labels.push_back({startIndex, -1, 0.0, 0.0, 0.0, true});
+   fronts[startIndex].push_back(0);
+   queue.push(QueueElement(distanceBounds[startIndex], weightBounds[startIndex], 0));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   while (!queue.empty()) {
+      if (cancellation.shouldStop()) {
+         return routes;
+      }
+      int label = std::get<2>(queue.top());
+      queue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      const Label current = labels[label];
+      if (!current.alive || (current.vertex != targetIndex && isHopeless(current.vertex, current.distance, current.maxWeight))) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      if (current.vertex == targetIndex) {
+         continue;   // Routes going through the target and back are not better.
+      }
+      for (std::size_t edge = offsets[current.vertex]; edge < offsets[current.vertex + 1]; edge++) {
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         int destination = destinations[edge];
+         double distance = current.distance + weights[edge];
+         double maxWeight = std::max(current.maxWeight, weights[edge]);
+         if (distanceBounds[destination] == infinity || isHopeless(destination, distance, maxWeight) ||
+             isDominated(fronts[destination], labels, distance, maxWeight)) {
+            continue;
+         }
+         labels.push_back({destination, label, distance, maxWeight, weights[edge], true});
+         int added = static_cast<int>(labels.size()) - 1;
+         if (addToFront(fronts[destination], labels, added)) {
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            queue.push(QueueElement(distance + distanceBounds[destination], std::max(maxWeight, weightBounds[destination]), added));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(queue.size());
+         }
+      }
+   }
+   for (int label : targetFront) {
+      ParetoRoute<T> route{labels[label].distance, labels[label].maxWeight, {}};
+      for (int step = label; labels[step].parent >= 0; step = labels[step].parent) {
+         route.edges.push_back(Edge<T>(vertices[labels[labels[step].parent].vertex], vertices[labels[step].vertex], labels[step].weight));
+      }
+      std::reverse(route.edges.begin(), route.edges.end());
+      routes.push_back(std::move(route));
+   }
+   return routes;
+}
+
+/*
+ Dijkstra backwards from the target, with the sum or the max of the weights.
+ */
+template <typename T>
+bool ParetoRouting<T>::boundsTo(int target, bool lowest, std::vector<double> & bounds, CancellationCheck & cancellation) const {
+   typedef std::pair<double, int> BoundElement;
+   bounds.assign(vertices.size(), std::numeric_limits<double>::infinity());
+   std::priority_queue<BoundElement, std::vector<BoundElement>, std::greater<BoundElement>> queue;
+   bounds[target] = 0.0;
+   queue.push(BoundElement(0.0, target));
+   while (!queue.empty()) {
+      if (cancellation.shouldStop()) {
+         return false;
+      }
+      auto [bound, vertex] = queue.top();
+      queue.pop();
+      if (bound > bounds[vertex]) {
+         continue;
+      }
+      for (std::size_t edge = reverseOffsets[vertex]; edge < reverseOffsets[vertex + 1]; edge++) {
+         double candidate = lowest ? std::max(bound, reverseWeights[edge]) : bound + reverseWeights[edge];
+         if (candidate < bounds[sources[edge]]) {
+            bounds[sources[edge]] = candidate;
+            queue.push(BoundElement(candidate, sources[edge]));
+         }
+      }
+   }
+   return true;
+}
+
+/*
+ The label with the largest max weight not above maxWeight has the smallest distance
+ of the labels not above it, so it is the only one that needs to be compared.
+ Equal costs count as dominated, so each route cost is kept once.
+ */
+template <typename T>
+bool ParetoRouting<T>::isDominated(const Front & front, const std::vector<Label> & labels, double distance, double maxWeight) {
+   auto above = std::upper_bound(front.begin(), front.end(), maxWeight, [&labels](double weight, int label) {
+      return weight < labels[label].maxWeight;
+   });
+   return above != front.begin() && labels[*(above - 1)].distance <= distance;
+}
+
+/*
+ The labels the new one dominates have at least its max weight and distance, so they
+ follow it in the front, one after another.
+ */
+template <typename T>
+bool ParetoRouting<T>::addToFront(Front & front, std::vector<Label> & labels, int label) const {
+   const Label & added = labels[label];
+   auto position = std::lower_bound(front.begin(), front.end(), added.maxWeight, [&labels](int another, double weight) {
+      return labels[another].maxWeight < weight;
+   });
+   auto dominated = position;
+   while (dominated != front.end() && labels[*dominated].distance >= added.distance) {
+      labels[*dominated].alive = false;
+      ++dominated;
+   }
+   position = front.erase(position, dominated);
+   front.insert(position, label);
+   if (maxLabels > 0 && front.size() > std::max<std::size_t>(maxLabels, 2)) {
+      // Drop the label whose distance is nearest to the one before it, keeping the ends.
+      std::size_t nearest = 1;
+      for (std::size_t index = 2; index + 1 < front.size(); index++) {
+         if (labels[front[index - 1]].distance - labels[front[index]].distance <
+             labels[front[nearest - 1]].distance - labels[front[nearest]].distance) {
+            nearest = index;
+         }
+      }
+      labels[front[nearest]].alive = false;
+      front.erase(front.begin() + nearest);
+   }
+   return labels[label].alive;
+}
+
+#endif /* ParetoRouting_hpp */
@@ -0,0 +1,198 @@
+#ifndef PathCache_hpp
+#define PathCache_hpp
+
+#include <map>       // the cache lookup table
+#include <list>      // entries in the least recently used order
+#include <memory>    // shared_ptr, cached trees are shared with the callers
+#include <mutex>     // cache may be used from several threads reading the same graph
+
+#include "Vertex.hpp"
+#include "ShortestPathTree.hpp"
+
+/// The search algorithm that produced the cached paths.
+enum PathAlgorithm {
+   EShortestPaths,   // Dijkstra::shortestPathsFrom, sum of the edge weights
+   ELowestPaths      // Dijkstra::lowestPathsFrom, highest edge weight on the path
+};
+
+/// A bounded least recently used (LRU) cache of path search results.
+/// Paths are keyed by the starting vertex, the version of the graph the search
+/// was done against and the algorithm used. Graph owns a cache and Dijkstra
+/// consults it before searching, so repeated searches from the same start vertex
+/// are answered without searching again as long as the graph has not changed.
+template <typename T>
+class PathCache {
+public:
+   /// The cached search result.
+   typedef ShortestPathTree<T> Paths;
+
+   /// Creates a cache holding at most capacity search results. Zero disables caching.
+   PathCache(std::size_t capacity = 16);
+   /// Copying a cache copies the capacity, not the cached paths.
+   PathCache(const PathCache<T> & another);
+   const PathCache<T> & operator = (const PathCache<T> & another);
+
+   /// Finds the paths from start, searched with the algorithm from the given graph version.
+   /// Returns an empty pointer if the paths are not in the cache.
+   std::shared_ptr<const Paths> find(const Vertex<T> & start, unsigned long version, PathAlgorithm algorithm);
+   /// Puts the paths into the cache, dropping the least recently used paths if the cache is full.
+   void insert(const Vertex<T> & start, unsigned long version, PathAlgorithm algorithm, std::shared_ptr<const Paths> paths);
+
+   /// Removes all the cached paths.
+   void clear();
+   /// Sets the maximum number of cached search results. Zero disables caching.
+   void setCapacity(std::size_t capacity);
+   /// Gets the maximum number of cached search results.
+   std::size_t capacity() const;
+   /// Gets the number of cached search results.
+   std::size_t size() const;
+   /// Number of times find() found the paths from the cache.
+   unsigned long hits() const;
+   /// Number of times find() did not find the paths from the cache.
+   unsigned long misses() const;
+
+private:
+   /// The key of the cached paths.
+   struct Key {
+      Vertex<T> start;
+      unsigned long version;
+      PathAlgorithm algorithm;
+
+      bool operator < (const Key & another) const {
+         if (version != another.version) {
+            return version < another.version;
+         }
+         if (algorithm != another.algorithm) {
+            return algorithm < another.algorithm;
+         }
+         return start < another.start;
+      }
+   };
+   typedef std::list<std::pair<Key, std::shared_ptr<const Paths>>> Entries;
+
+   /// Drops the least recently used entries until there are at most count entries.
+   void shrinkTo(std::size_t count);
+
+   /// Cached paths, most recently used first.
+   Entries entries;
+   /// Finds the entry in the list using the key.
+   std::map<Key, typename Entries::iterator> lookup;
+   std::size_t maxEntries;
+   unsigned long hitCount;
+   unsigned long missCount;
+   mutable std::mutex mutex;
+};
+
+
+template <typename T>
+PathCache<T>::PathCache(std::size_t capacity)
+: maxEntries(capacity), hitCount(0), missCount(0) {
+}
+
+template <typename T>
+PathCache<T>::PathCache(const PathCache<T> & another)
+: maxEntries(another.capacity()), hitCount(0), missCount(0) {
+}
+
+template <typename T>
+const PathCache<T> & PathCache<T>::operator = (const PathCache<T> & another) {
+   if (this != &another) {
+      std::size_t capacity = another.capacity();
+      std::lock_guard<std::mutex> guard(mutex);
+      entries.clear();
+      lookup.clear();
+      maxEntries = capacity;
+   }
+   return *this;
+}
+
+/*
+ Looks up the paths. If found, the entry is moved to the front of the list
+ since it is now the most recently used one.
+ */
+template <typename T>
+std::shared_ptr<const typename PathCache<T>::Paths> PathCache<T>::find(const Vertex<T> & start, unsigned long version, PathAlgorithm algorithm) {
+   std::lock_guard<std::mutex> guard(mutex);
+   auto found = lookup.find(Key{start, version, algorithm});
+   if (found == lookup.end()) {
+      missCount++;
+      return nullptr;
+   }
+   hitCount++;
+   entries.splice(entries.begin(), entries, found->second);
+   return found->second->second;
+}
+
+/*
+ Inserts the paths as the most recently used entry. Entries from older graph versions
+ can never be found again, since the version only grows, so those are dropped here.
+ */
+template <typename T>
+void PathCache<T>::insert(const Vertex<T> & start, unsigned long version, PathAlgorithm algorithm, std::shared_ptr<const Paths> paths) {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (maxEntries == 0) {
+      return;
+   }
+   while (!lookup.empty() && lookup.begin()->first.version < version) {
+      entries.erase(lookup.begin()->second);
+      lookup.erase(lookup.begin());
+   }
+   Key key{start, version, algorithm};
+   auto found = lookup.find(key);
+   if (found != lookup.end()) {
+      entries.erase(found->second);
+      lookup.erase(found);
+   }
+   shrinkTo(maxEntries - 1);
+   entries.push_front(std::make_pair(key, paths));
+   lookup[key] = entries.begin();
+}
+
+template <typename T>
+void PathCache<T>::clear() {
+   std::lock_guard<std::mutex> guard(mutex);
+   entries.clear();
+   lookup.clear();
+}
+
+template <typename T>
+void PathCache<T>::setCapacity(std::size_t capacity) {
+   std::lock_guard<std::mutex> guard(mutex);
+   maxEntries = capacity;
+   shrinkTo(maxEntries);
+}
+
+template <typename T>
+std::size_t PathCache<T>::capacity() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return maxEntries;
+}
+
+template <typename T>
+std::size_t PathCache<T>::size() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return entries.size();
+}
+
+template <typename T>
+unsigned long PathCache<T>::hits() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return hitCount;
+}
+
+template <typename T>
+unsigned long PathCache<T>::misses() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return missCount;
+}
+
+// Caller holds the mutex.
+template <typename T>
+void PathCache<T>::shrinkTo(std::size_t count) {
+   while (entries.size() > count) {
+      lookup.erase(entries.back().first);
+      entries.pop_back();
+   }
+}
+
+#endif /* PathCache_hpp */
@@ -5,6 +5,8 @@
 #include <utility> // for make_pair
 
 #include "Graph.hpp"
+#include "GraphView.hpp"
+#include "AlgorithmStats.hpp"
 
 /**
  Prim algorithm finds the minimum spanning three for an undirected graph.
@@ -18,15 +20,25 @@ class Prim {
 public:
    Prim();
 
-   // A helper function used by the produceMinimumSpanningTreeFor().
+   // A helper function used by the produceMinimumSpanningTreeFor(). A graph can be given as the view.
    void addAvailableEdges(const Vertex<T> & vertex,
-                          const Graph<T> & graph,
+                          const GraphView<T> & view,
                           const std::set<Vertex<T>> & visited,
-                          std::priority_queue<Edge<T>, std::vector<Edge<T>>, weight_compare<T>> & toQueue);
+                          std::priority_queue<Edge<T>, std::vector<Edge<T>>, weight_compare<T>> & toQueue,
+                          AlgorithmStats * stats = nullptr);
 
    // The work of Prim algorithm is done in this function, for a graph given as parameter.
    // Function returns a pair containing the 1) total cost of the weights in 2) the minumum spanning tree.
    std::pair<double,Graph<T>> produceMinimumSpanningTreeFor(const Graph<T> & graph);
+   // Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   std::pair<double,Graph<T>> produceMinimumSpanningTreeFor(const Graph<T> & graph, AlgorithmStats & stats);
+   // Minimum spanning tree of the vertices and edges in the view, without copying the graph.
+   std::pair<double,Graph<T>> produceMinimumSpanningTreeFor(const GraphView<T> & view);
+   std::pair<double,Graph<T>> produceMinimumSpanningTreeFor(const GraphView<T> & view, AlgorithmStats & stats);
+
+private:
+   // Does the work for all of the public functions.
+   std::pair<double,Graph<T>> minimumSpanningTree(const GraphView<T> & view, AlgorithmStats * stats);
 };
 
 // Nothing to do here.
@@ -40,13 +52,22 @@ Prim<T>::Prim() {
  */
 template <typename T>
 void Prim<T>::addAvailableEdges(const Vertex<T> & vertex,
-                              const Graph<T> & graph,
+                              const GraphView<T> & view,
                               const std::set<Vertex<T>> & visited,
-                              std::priority_queue<Edge<T>, std::vector<Edge<T>>, weight_compare<T>> & toQueue) {
+                              std::priority_queue<Edge<T>, std::vector<Edge<T>>, weight_compare<T>> & toQueue,
+                              [[maybe_unused]] AlgorithmStats * stats) {
 
-   for (const Edge<T> & edge : graph.edges(vertex)) {
+   const bool filtered = view.isFiltered();
+   GRAPH_STATS_ADD(stats, lookups, 1);
+   for (const Edge<T> & edge : view.graph.edges(vertex)) {
+      GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+      if (filtered && !view.includes(edge)) {
+         continue;
+      }
+      GRAPH_STATS_ADD(stats, lookups, 1);
       if (visited.find(edge.destination) == visited.end()) {
          toQueue.push(edge);
+         GRAPH_STATS_ADD(stats, heapPushes, 1);
       }
    }
 }
@@ -60,6 +81,28 @@ void Prim<T>::addAvailableEdges(const Vertex<T> & vertex,
  */
 template <typename T>
 std::pair<double,Graph<T>> Prim<T>::produceMinimumSpanningTreeFor(const Graph<T> & graph) {
+   return minimumSpanningTree(GraphView<T>(graph), nullptr);
+}
+
+template <typename T>
+std::pair<double,Graph<T>> Prim<T>::produceMinimumSpanningTreeFor(const Graph<T> & graph, AlgorithmStats & stats) {
+   return minimumSpanningTree(GraphView<T>(graph), &stats);
+}
+
+template <typename T>
+std::pair<double,Graph<T>> Prim<T>::produceMinimumSpanningTreeFor(const GraphView<T> & view) {
+   return minimumSpanningTree(view, nullptr);
+}
+
+template <typename T>
+std::pair<double,Graph<T>> Prim<T>::produceMinimumSpanningTreeFor(const GraphView<T> & view, AlgorithmStats & stats) {
+   return minimumSpanningTree(view, &stats);
+}
+
+template <typename T>
+std::pair<double,Graph<T>> Prim<T>::minimumSpanningTree(const GraphView<T> & view, AlgorithmStats * stats) {
+   GRAPH_TRACE_SPAN("Prim::produceMinimumSpanningTreeFor");
+   StatsTimer timer(stats);
    double cost = 0.0;
    // Contains the new graph with minimum spanning tree, returned form the function.
    Graph<T> minimumSpanningTree;
@@ -74,38 +117,58 @@ std::pair<double,Graph<T>> Prim<T>::produceMinimumSpanningTreeFor(const Graph<T>
    // largest elements out of the queue first.
    std::priority_queue<Edge<T>, std::vector<Edge<T>>, weight_compare<T>> priorityQueue;
 
-   minimumSpanningTree.copyVerticesFrom(graph);     // Copy vertices from the original graph, no edges.
+   const Graph<T> & graph = view.graph;
+   // Copy vertices from the original graph (or those in the view), no edges.
+   if (view.isFiltered()) {
+      for (const auto & vertex : view.allVertices()) {
+         minimumSpanningTree.createVertex(vertex.data);
+      }
+   } else {
+      minimumSpanningTree.copyVerticesFrom(graph);
+   }
+   GRAPH_STATS_ADD(stats, allocations, minimumSpanningTree.adjacencies.size());   // One map node per vertex added.
 
    // If the graph has nothing in, return cost of 0.0 and the empty minimum spanning tree.
-   if (graph.adjacencies.empty()) {
+   if (minimumSpanningTree.adjacencies.empty()) {
       return std::make_pair(cost, minimumSpanningTree);
    }
    // Start handling the graph from the first element.
-   Vertex<T> start = graph.adjacencies.begin()->first;
+   Vertex<T> start = minimumSpanningTree.adjacencies.begin()->first;
    visited.insert(start);
+   GRAPH_STATS_ADD(stats, verticesSettled, 1);
    // Add the available edges from the starting vertex to the priority queue from the graph
    // if it has not been visited before.
-   addAvailableEdges(start, graph, visited, priorityQueue);
+   addAvailableEdges(start, view, visited, priorityQueue, stats);
+   GrowthCounter queueGrowth(stats);
+   queueGrowth.sizeIs(priorityQueue.size());
    // While there are things in the queue...
    while (!priorityQueue.empty()) {
       // Take the edge with smallest distance...
       const auto smallestEdge = priorityQueue.top();
       priorityQueue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
       // ...check the destination and if we have visited it, take the next item from the queue.
       const auto vertex = smallestEdge.destination;
+      GRAPH_STATS_ADD(stats, lookups, 1);
       if (visited.find(vertex) != visited.end()) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
          continue;
       }
       // Otherwise, insert the destination to the visited set.
       visited.insert(vertex);
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      GRAPH_STATS_ADD(stats, edgesImproved, 1);
+      GRAPH_STATS_ADD(stats, lookups, 1);
       // Add the weight of the edge to total cost.
       cost += smallestEdge.weight;
       // And add the edge's source and destination with the weight to the minimum spanning tree...
       minimumSpanningTree.add(EdgeType::EUndirected, smallestEdge.source, smallestEdge.destination, smallestEdge.weight);
       // ...and add the available edges from this vertex to the priority queue from the graph
       // if it has not been visited before.
-      addAvailableEdges(vertex, graph, visited, priorityQueue);
+      addAvailableEdges(vertex, view, visited, priorityQueue, stats);
+      queueGrowth.sizeIs(priorityQueue.size());
    }
+   GRAPH_STATS_ADD(stats, allocations, visited.size());   // One set node per visited vertex.
    // Finished, so take the total cost of the minimum spanning tree and the tree itself,
    // make a pair out of them and return the pair to the caller.
    return std::make_pair(cost, minimumSpanningTree);
@@ -0,0 +1,235 @@
+#ifndef QueryExecutor_hpp
+#define QueryExecutor_hpp
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <future>              // results are given as futures
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <exception>
+
+#include "Graph.hpp"
+#include "Dijkstra.hpp"
+#include "Cancellation.hpp"
+
+/// Given by the future of a query stopped by cancel() or its deadline before it was done.
+class QueryCancelled : public std::runtime_error {
+public:
+   QueryCancelled() : std::runtime_error("query cancelled") { }
+};
+
+/// Given by the future of a query not run because the queue was full or the executor was stopping.
+class QueryRejected : public std::runtime_error {
+public:
+   QueryRejected() : std::runtime_error("query rejected") { }
+};
+
+/// Runs path and traversal queries on a pool of worker threads, giving the results as futures.
+///
+/// Each query has a CancellationToken, cancelled by its deadline or by the caller. The searches
+/// check the token while searching, so a query that runs past its deadline stops within
+/// microseconds, and its future gives QueryCancelled instead of the result. A query still waiting
+/// in the queue when its deadline passes is not run at all.
+///
+/// At most maxQueued queries wait for a worker; more are rejected with QueryRejected right away,
+/// so a caller under too much load fails fast instead of waiting for ever longer.
+///
+/// The graph is given as a shared pointer, e.g. a snapshot of a VersionedGraph, so it stays
+/// alive until the query is done.
+template <typename T>
+class QueryExecutor {
+public:
+   typedef std::shared_ptr<const Graph<T>> GraphPointer;
+   typedef std::shared_ptr<const ShortestPathTree<T>> Paths;
+   typedef CancellationToken::Clock::time_point Deadline;
+
+   /// A submitted query. The result is got from the future; cancel() stops the query.
+   template <typename Result>
+   struct Query {
+      std::future<Result> result;
+      std::shared_ptr<CancellationToken> token;
+      void cancel() const { token->cancel(); }
+   };
+
+   /// Starts the worker threads.
+   explicit QueryExecutor(int threads, std::size_t maxQueued = 1024);
+   /// Rejects the waiting queries, cancels the running ones and waits for the workers to end.
+   ~QueryExecutor();
+   QueryExecutor(const QueryExecutor &) = delete;
+   const QueryExecutor & operator = (const QueryExecutor &) = delete;
+
+   /// Shortest paths (sum of the weights) from the start, see Dijkstra::shortestPathTreeFrom.
+   Query<Paths> shortestPaths(GraphPointer graph, const Vertex<T> & start, Deadline deadline = Deadline::max());
+   /// Bottleneck paths (lowest max weight) from the start, see Dijkstra::lowestPathTreeFrom.
+   Query<Paths> lowestPaths(GraphPointer graph, const Vertex<T> & start, Deadline deadline = Deadline::max());
+   /// Vertices reachable from the start in breadth first order, see Graph::breadthFirstSearchFrom.
+   Query<std::vector<Vertex<T>>> breadthFirstSearch(GraphPointer graph, const Vertex<T> & start, Deadline deadline = Deadline::max());
+
+   /// Number of queries waiting for a worker.
+   std::size_t queued() const;
+
+private:
+   /// A query waiting in the queue. run() gives the result or the error to the future,
+   /// reject() gives the error when the query is not run.
+   struct Task {
+      std::shared_ptr<CancellationToken> token;
+      std::function<void()> run;
+      std::function<void(std::exception_ptr)> reject;
+   };
+
+   /// Queues the search. Search gets the token and returns the result, or nothing if stopped.
+   template <typename Result, typename Search>
+   Query<Result> submit(Deadline deadline, Search search);
+   void work(std::size_t worker);
+
+   mutable std::mutex mutex;         // Guards everything below.
+   std::condition_variable tasksAvailable;
+   std::deque<Task> tasks;
+   std::size_t maxQueued;
+   bool stopping = false;
+   std::vector<std::shared_ptr<CancellationToken>> running;   // Token of the query each worker runs.
+   std::vector<std::thread> workers;
+};
+
+
+template <typename T>
+QueryExecutor<T>::QueryExecutor(int threads, std::size_t maxQueued)
+: maxQueued(maxQueued), running(std::max(1, threads)) {
+   for (std::size_t worker = 0; worker < running.size(); worker++) {
+      workers.emplace_back(&QueryExecutor<T>::work, this, worker);
+   }
+}
+
+template <typename T>
+QueryExecutor<T>::~QueryExecutor() {
+   std::deque<Task> rejected;
+   {
+      std::lock_guard<std::mutex> guard(mutex);
+      stopping = true;
+      rejected.swap(tasks);
+      for (const auto & token : running) {
+         if (token) {
+            token->cancel();
+         }
+      }
+   }
+   tasksAvailable.notify_all();
+   for (auto & task : rejected) {
+      task.reject(std::make_exception_ptr(QueryRejected()));
+   }
+   for (auto & worker : workers) {
+      worker.join();
+   }
+}
+
+template <typename T>
+typename QueryExecutor<T>::template Query<typename QueryExecutor<T>::Paths>
+QueryExecutor<T>::shortestPaths(GraphPointer graph, const Vertex<T> & start, Deadline deadline) {
+   return submit<Paths>(deadline, [graph, start](const CancellationToken & token) -> std::optional<Paths> {
+      auto paths = Dijkstra<T>(*graph).shortestPathTreeFrom(start, token);
+      return paths ? std::optional<Paths>(paths) : std::nullopt;
+   });
+}
+
+template <typename T>
+typename QueryExecutor<T>::template Query<typename QueryExecutor<T>::Paths>
+QueryExecutor<T>::lowestPaths(GraphPointer graph, const Vertex<T> & start, Deadline deadline) {
+   return submit<Paths>(deadline, [graph, start](const CancellationToken & token) -> std::optional<Paths> {
+      auto paths = Dijkstra<T>(*graph).lowestPathTreeFrom(start, token);
+      return paths ? std::optional<Paths>(paths) : std::nullopt;
+   });
+}
+
+/*
+ The search gives the vertices found before it was stopped, so a search finishing
+ after the token was cancelled is taken as stopped.
+ */
+template <typename T>
+typename QueryExecutor<T>::template Query<std::vector<Vertex<T>>>
+QueryExecutor<T>::breadthFirstSearch(GraphPointer graph, const Vertex<T> & start, Deadline deadline) {
+   return submit<std::vector<Vertex<T>>>(deadline, [graph, start](const CancellationToken & token) -> std::optional<std::vector<Vertex<T>>> {
+      auto vertices = graph->breadthFirstSearchFrom(start, token);
+      if (token.isCancelled()) {
+         return std::nullopt;
+      }
+      return vertices;
+   });
+}
+
+template <typename T>
+std::size_t QueryExecutor<T>::queued() const {
+   std::lock_guard<std::mutex> guard(mutex);
+   return tasks.size();
+}
+
+/*
+ The promise is shared by run() and reject(), only one of them is ever called.
+ */
+template <typename T>
+template <typename Result, typename Search>
+typename QueryExecutor<T>::template Query<Result> QueryExecutor<T>::submit(Deadline deadline, Search search) {
+   auto promise = std::make_shared<std::promise<Result>>();
+   auto token = std::make_shared<CancellationToken>(deadline);
+   Query<Result> query{promise->get_future(), token};
+   Task task;
+   task.token = token;
+   task.run = [promise, token, search]() {
+      try {
+         auto result = search(*token);
+         if (result) {
+            promise->set_value(std::move(*result));
+         } else {
+            promise->set_exception(std::make_exception_ptr(QueryCancelled()));
+         }
+      } catch (...) {
+         promise->set_exception(std::current_exception());
+      }
+   };
+   task.reject = [promise](std::exception_ptr error) {
+      promise->set_exception(error);
+   };
+   {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!stopping && tasks.size() < maxQueued) {
+         tasks.push_back(std::move(task));
+         task.reject = nullptr;
+      }
+   }
+   if (task.reject) {
+      task.reject(std::make_exception_ptr(QueryRejected()));
+   } else {
+      tasksAvailable.notify_one();
+   }
+   return query;
+}
+
+template <typename T>
+void QueryExecutor<T>::work(std::size_t worker) {
+   while (true) {
+      Task task;
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         tasksAvailable.wait(lock, [this] { return !tasks.empty() || stopping; });
+         if (stopping) {
+            return;
+         }
+         task = std::move(tasks.front());
+         tasks.pop_front();
+         running[worker] = task.token;
+      }
+      if (task.token->isCancelled()) {
+         task.reject(std::make_exception_ptr(QueryCancelled()));
+      } else {
+         task.run();
+      }
+      std::lock_guard<std::mutex> guard(mutex);
+      running[worker].reset();
+   }
+}
+
+#endif /* QueryExecutor_hpp */
@@ -0,0 +1,426 @@
+#ifndef Reachability_hpp
+#define Reachability_hpp
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "Graph.hpp"
+#include "Trace.hpp"
+
+/**
+ Answers if a vertex can be reached from another one without searching the graph for each
+ question, e.g. if a course is a prerequisite of another one, also through other courses.
+
+ The vertices reaching each other (the strongly connected components, found with Tarjan's
+ algorithm) reach the same vertices, so the index is built for the components. The graph of
+ the components (the condensation) is acyclic, and Tarjan's algorithm numbers the components
+ so that edges go from a larger number to a smaller one. A component can then reach only
+ components with a smaller or the same number.
+
+ If the bitsets fit in maxBitsetBytes, each component has a bitset of the components it
+ reaches, made going through the components from the smallest number to the largest and
+ or-ing together the bitsets of the components it has edges to, 64 bits at a time in loops
+ the compiler can vectorize. A bitset only needs the bits up to its own component, so the
+ bitsets take about components^2 / 16 bytes. Then each question is answered in O(1).
+
+ Larger graphs get interval labels instead, a few integers for each component. Each labeling
+ numbers the components in the order a depth first search finishes them, going through the
+ edges in a different order in each labeling, and gives each component the range from the
+ smallest number it reaches to its own. A component can reach only components whose ranges
+ are inside its ranges, so most questions with the answer no are answered without searching.
+ The ranges of the first two search trees are also kept, answering yes for the components
+ below in the trees. The other questions are answered by a depth first search of the
+ components, skipping the ones whose ranges show they cannot reach the target.
+
+ The index is not updated when the graph changes, and dangling edges are ignored. In the
+ interval mode, the searches reuse arrays of the index, so an index should be used by one
+ thread at a time.
+ */
+template <typename T>
+class Reachability {
+public:
+   /// Builds the index. Bitsets are used if they take at most maxBitsetBytes, otherwise the
+   /// index has labelings interval labelings of the components.
+   Reachability(const Graph<T> & graph, std::size_t maxBitsetBytes = 256 * 1024 * 1024, int labelings = 3);
+
+   /// Can the target be reached from the source. A vertex always reaches itself.
+   /// False if either of them is not in the graph.
+   bool reaches(const Vertex<T> & source, const Vertex<T> & target) const;
+   /// Like above, with the indices of the vertices in the order of the graph's adjacencies.
+   bool reaches(int source, int target) const;
+
+   /// Index of the vertex in the order of the graph's adjacencies, -1 if not in the graph.
+   int indexOf(const Vertex<T> & vertex) const;
+   /// Number of the strongly connected component the vertex with the index is in.
+   int componentOf(int index) const;
+   /// Number of strongly connected components.
+   int componentCount() const;
+   /// Are the reachable components kept as bitsets, instead of interval labels.
+   bool usesBitsets() const;
+   /// Bytes used by the index, not counting the vertices.
+   std::size_t indexBytes() const;
+
+private:
+   /// Finds the strongly connected components of the graph in the arrays.
+   void findComponents(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations);
+   /// Makes the edges between the components, each once.
+   void condense(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations);
+   void buildBitsets();
+   void buildLabels(int labelings);
+   /// Do the labels allow source to reach target.
+   bool mayReach(int source, int target) const;
+   /// Is target below source in the search tree of the first or the second labeling.
+   bool treeReaches(int source, int target) const;
+   /// Searches the components from source, using the labels to skip the hopeless ones.
+   bool searchReaches(int source, int target) const;
+
+   std::vector<Vertex<T>> vertices;          // Graph order.
+   std::vector<int> components;              // Component of each vertex.
+   int count = 0;                            // Number of components.
+   std::vector<std::size_t> componentOffsets; // Edges of component c are componentEdges[componentOffsets[c]...].
+   std::vector<int> componentEdges;
+
+   bool bitsets = false;
+   std::vector<std::size_t> rowOffsets;      // Bitset of component c starts at rows[rowOffsets[c]].
+   std::vector<std::uint64_t> rows;
+
+   int labelCount = 0;
+   std::vector<int> finished;                // Finishing number of each component in each labeling.
+   std::vector<int> lowest;                  // Smallest finishing number reached, in each labeling.
+   std::vector<int> treeLowest;              // Smallest finishing number below in the tree, in the first two labelings.
+   mutable std::vector<unsigned> visited;    // Search stamp of each component.
+   mutable unsigned stamp = 0;
+   mutable std::vector<int> stack;
+};
+
+
+/*
+ The graph is copied to arrays indexed by the vertices first. The arrays of the vertices
+ are not needed after the components are found, so only the components are kept.
+ */
+template <typename T>
+Reachability<T>::Reachability(const Graph<T> & graph, std::size_t maxBitsetBytes, int labelings) {
+   GRAPH_TRACE_SPAN("Reachability::build");
+   vertices.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+   }
+   std::vector<std::size_t> offsets;
+   std::vector<int> destinations;
+   offsets.reserve(vertices.size() + 1);
+   offsets.push_back(0);
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      for (const auto & edge : vertexAndEdges.second) {
+         int destination = indexOf(edge.destination);
+         if (destination >= 0) {
+            destinations.push_back(destination);
+         }
+      }
+      offsets.push_back(destinations.size());
+   }
+   findComponents(offsets, destinations);
+   condense(offsets, destinations);
+   // Bitset of component c has c / 64 + 1 words.
+   std::size_t words = 0;
+   for (std::size_t component = 0; component < static_cast<std::size_t>(count) && words <= maxBitsetBytes / sizeof(std::uint64_t); component++) {
+      words += component / 64 + 1;
+   }
+   if (words * sizeof(std::uint64_t) <= maxBitsetBytes) {
+      buildBitsets();
+   } else {
+      buildLabels(std::max(1, labelings));
+   }
+}
+
+template <typename T>
+bool Reachability<T>::reaches(const Vertex<T> & source, const Vertex<T> & target) const {
+   int sourceIndex = indexOf(source);
+   int targetIndex = indexOf(target);
+   return sourceIndex >= 0 && targetIndex >= 0 && reaches(sourceIndex, targetIndex);
+}
+
+template <typename T>
+bool Reachability<T>::reaches(int source, int target) const {
+   int from = components[source];
+   int to = components[target];
+   if (from == to) {
+      return true;
+   }
+   if (to > from) {
+      return false;
+   }
+   if (bitsets) {
+      return (rows[rowOffsets[from] + to / 64] >> (to % 64)) & 1;
+   }
+   if (!mayReach(from, to)) {
+      return false;
+   }
+   return treeReaches(from, to) || searchReaches(from, to);
+}
+
+template <typename T>
+int Reachability<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - vertices.begin());
+}
+
+template <typename T>
+int Reachability<T>::componentOf(int index) const {
+   return components[index];
+}
+
+template <typename T>
+int Reachability<T>::componentCount() const {
+   return count;
+}
+
+template <typename T>
+bool Reachability<T>::usesBitsets() const {
+   return bitsets;
+}
+
+template <typename T>
+std::size_t Reachability<T>::indexBytes() const {
+   return components.size() * sizeof(int) + componentOffsets.size() * sizeof(std::size_t) +
+          componentEdges.size() * sizeof(int) + rowOffsets.size() * sizeof(std::size_t) +
+          rows.size() * sizeof(std::uint64_t) +
+          (finished.size() + lowest.size() + treeLowest.size() + visited.size()) * sizeof(int);
+}
+
+/*
+ Tarjan's algorithm with an explicit stack of the vertices being searched and the next edge
+ of each, so deep graphs do not run out of the call stack. A component is numbered when its
+ root is finished, after all the components it reaches.
+ */
+template <typename T>
+void Reachability<T>::findComponents(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations) {
+   const int vertexCount = static_cast<int>(vertices.size());
+   components.assign(vertexCount, -1);
+   std::vector<int> order(vertexCount, -1);       // Order the vertices were found in.
+   std::vector<int> low(vertexCount, 0);          // Smallest order reached from the vertex.
+   std::vector<int> open;                         // Found vertices without a component yet.
+   std::vector<std::pair<int, std::size_t>> path; // Searched vertex and its next edge.
+   int found = 0;
+   for (int root = 0; root < vertexCount; root++) {
+      if (order[root] >= 0) {
+         continue;
+      }
+      order[root] = low[root] = found++;
+      open.push_back(root);
+      path.push_back({root, offsets[root]});
+      while (!path.empty()) {
+         auto & [vertex, edge] = path.back();
+         if (edge < offsets[vertex + 1]) {
+            int destination = destinations[edge++];
+            if (order[destination] < 0) {
+               order[destination] = low[destination] = found++;
+               open.push_back(destination);
+               path.push_back({destination, offsets[destination]});
+            } else if (components[destination] < 0) {
+               low[vertex] = std::min(low[vertex], order[destination]);
+            }
+            continue;
+         }
+         int finishedVertex = vertex;
+         path.pop_back();
+         if (!path.empty()) {
+            low[path.back().first] = std::min(low[path.back().first], low[finishedVertex]);
+         }
+         if (low[finishedVertex] == order[finishedVertex]) {
+            int member;
+            do {
+               member = open.back();
+               open.pop_back();
+               components[member] = count;
+            } while (member != finishedVertex);
+            count++;
+         }
+      }
+   }
+}
+
+template <typename T>
+void Reachability<T>::condense(const std::vector<std::size_t> & offsets, const std::vector<int> & destinations) {
+   // Vertices of each component, to go through the edges component by component.
+   std::vector<int> memberOffsets(count + 1, 0);
+   for (int component : components) {
+      memberOffsets[component + 1]++;
+   }
+   for (int component = 0; component < count; component++) {
+      memberOffsets[component + 1] += memberOffsets[component];
+   }
+   std::vector<int> members(components.size());
+   std::vector<int> position(memberOffsets.begin(), memberOffsets.end() - 1);
+   for (int vertex = 0; vertex < static_cast<int>(components.size()); vertex++) {
+      members[position[components[vertex]]++] = vertex;
+   }
+   std::vector<int> added(count, -1);             // Last component having an edge to it.
+   componentOffsets.reserve(count + 1);
+   componentOffsets.push_back(0);
+   for (int component = 0; component < count; component++) {
+      for (int member = memberOffsets[component]; member < memberOffsets[component + 1]; member++) {
+         for (std::size_t edge = offsets[members[member]]; edge < offsets[members[member] + 1]; edge++) {
+            int destination = components[destinations[edge]];
+            if (destination != component && added[destination] != component) {
+               added[destination] = component;
+               componentEdges.push_back(destination);
+            }
+         }
+      }
+      componentOffsets.push_back(componentEdges.size());
+   }
+}
+
+/*
+ The components an edge goes to have smaller numbers, so their bitsets are ready, and
+ shorter than the bitset being made.
+ */
+template <typename T>
+void Reachability<T>::buildBitsets() {
+   bitsets = true;
+   rowOffsets.reserve(count + 1);
+   rowOffsets.push_back(0);
+   for (int component = 0; component < count; component++) {
+      rowOffsets.push_back(rowOffsets.back() + component / 64 + 1);
+   }
+   rows.assign(rowOffsets.back(), 0);
+   for (int component = 0; component < count; component++) {
+      std::uint64_t * row = rows.data() + rowOffsets[component];
+      row[component / 64] |= std::uint64_t(1) << (component % 64);
+      for (std::size_t edge = componentOffsets[component]; edge < componentOffsets[component + 1]; edge++) {
+         int destination = componentEdges[edge];
+         const std::uint64_t * reached = rows.data() + rowOffsets[destination];
+         const std::size_t words = destination / 64 + 1;
+         for (std::size_t word = 0; word < words; word++) {
+            row[word] |= reached[word];
+         }
+      }
+   }
+}
+
+/*
+ Each labeling starts the searches from the components without incoming edges. The first
+ labeling goes through the edges of each component in their order and the second one in the
+ reverse order; on graphs drawn on a plane, like grids, the two together tell most of the
+ components that cannot be reached. Later labelings start from a different edge of each
+ component. Smaller numbers are finished first, so the lowest numbers can be set when finishing.
+ */
+template <typename T>
+void Reachability<T>::buildLabels(int labelings) {
+   labelCount = labelings;
+   finished.assign(static_cast<std::size_t>(count) * labelings, -1);
+   lowest.assign(static_cast<std::size_t>(count) * labelings, 0);
+   treeLowest.assign(static_cast<std::size_t>(count) * std::min(labelings, 2), 0);
+   visited.assign(count, 0);
+   std::vector<bool> hasIncoming(count, false);
+   for (int destination : componentEdges) {
+      hasIncoming[destination] = true;
+   }
+   std::vector<std::pair<int, std::size_t>> path;   // Component and the number of edges gone through.
+   for (int labeling = 0; labeling < labelings; labeling++) {
+      int * finishing = finished.data() + static_cast<std::size_t>(labeling) * count;
+      int * low = lowest.data() + static_cast<std::size_t>(labeling) * count;
+      auto edgeAt = [&](int component, std::size_t done, std::size_t degree) {
+         if (labeling == 0) {
+            return componentOffsets[component] + done;
+         } else if (labeling == 1) {
+            return componentOffsets[component] + degree - 1 - done;
+         }
+         return componentOffsets[component] + (static_cast<std::size_t>(component) * 2654435761u + labeling * 40503u + done) % degree;
+      };
+      int next = 0;
+      for (int step = 0; step < count; step++) {
+         // The roots are taken from the largest number in odd labelings, to vary the trees.
+         int root = labeling % 2 == 0 ? step : count - 1 - step;
+         if (hasIncoming[root] || finishing[root] >= 0) {
+            continue;
+         }
+         finishing[root] = -2;
+         if (labeling < 2) {
+            treeLowest[static_cast<std::size_t>(labeling) * count + root] = next;
+         }
+         path.push_back({root, 0});
+         while (!path.empty()) {
+            auto & [component, done] = path.back();
+            std::size_t degree = componentOffsets[component + 1] - componentOffsets[component];
+            if (done < degree) {
+               int destination = componentEdges[edgeAt(component, done++, degree)];
+               if (finishing[destination] == -1) {
+                  finishing[destination] = -2;
+                  if (labeling < 2) {
+                     // The components finished before this one are the tree below it.
+                     treeLowest[static_cast<std::size_t>(labeling) * count + destination] = next;
+                  }
+                  path.push_back({destination, 0});
+               }
+               continue;
+            }
+            int finishedComponent = component;
+            path.pop_back();
+            finishing[finishedComponent] = next++;
+            low[finishedComponent] = finishing[finishedComponent];
+            for (std::size_t edge = componentOffsets[finishedComponent]; edge < componentOffsets[finishedComponent + 1]; edge++) {
+               low[finishedComponent] = std::min(low[finishedComponent], low[componentEdges[edge]]);
+            }
+         }
+      }
+   }
+}
+
+template <typename T>
+bool Reachability<T>::mayReach(int source, int target) const {
+   for (int labeling = 0; labeling < labelCount; labeling++) {
+      std::size_t offset = static_cast<std::size_t>(labeling) * count;
+      if (lowest[offset + target] < lowest[offset + source] || finished[offset + target] > finished[offset + source]) {
+         return false;
+      }
+   }
+   return true;
+}
+
+template <typename T>
+bool Reachability<T>::treeReaches(int source, int target) const {
+   for (int labeling = 0; labeling < std::min(labelCount, 2); labeling++) {
+      std::size_t offset = static_cast<std::size_t>(labeling) * count;
+      if (treeLowest[offset + source] <= finished[offset + target] && finished[offset + target] <= finished[offset + source]) {
+         return true;
+      }
+   }
+   return false;
+}
+
+template <typename T>
+bool Reachability<T>::searchReaches(int source, int target) const {
+   if (++stamp == 0) {
+      std::fill(visited.begin(), visited.end(), 0);
+      stamp = 1;
+   }
+   stack.clear();
+   stack.push_back(source);
+   visited[source] = stamp;
+   while (!stack.empty()) {
+      int component = stack.back();
+      stack.pop_back();
+      for (std::size_t edge = componentOffsets[component]; edge < componentOffsets[component + 1]; edge++) {
+         int destination = componentEdges[edge];
+         if (destination == target) {
+            return true;
+         }
+         if (destination < target || visited[destination] == stamp || !mayReach(destination, target)) {
+            continue;
+         }
+         if (treeReaches(destination, target)) {
+            return true;
+         }
+         visited[destination] = stamp;
+         stack.push_back(destination);
+      }
+   }
+   return false;
+}
+
+#endif /* Reachability_hpp */
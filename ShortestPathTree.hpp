@@ -0,0 +1,235 @@
+#ifndef ShortestPathTree_hpp
+#define ShortestPathTree_hpp
+
+#include <vector>    // flat arrays indexed by the vertex index
+#include <limits>    // infinity as the distance of vertices not reached
+#include <algorithm> // lower_bound for finding vertex indices
+
+#include "Vertex.hpp"
+#include "Edge.hpp"
+
+/// Result of a Dijkstra search from a start vertex.
+/// Vertices of the searched graph are numbered 0...size()-1 in the order of the graph
+/// (the order of Vertex operator <). For each vertex, the tree holds the index of the
+/// previous vertex on the path from the start, the weight of the edge from there and
+/// the distance from the start. Distance is either the sum of the edge weights
+/// (shortest paths) or the highest edge weight on the path (lowest paths).
+///
+/// Asking the distance of a vertex is a lookup from an array and routeTo() only
+/// walks the path, so using the tree does not allocate anything.
+/// Iterating the tree gives the indices of the reached vertices in the order
+/// they were settled by the search, so start first and parents before their children.
+template <typename T>
+class ShortestPathTree {
+public:
+   typedef std::vector<int>::const_iterator const_iterator;
+
+   /// Creates an empty tree.
+   ShortestPathTree();
+   /// Creates a tree for the vertices, all of them not yet reached.
+   /// Vertices must be in ascending order.
+   ShortestPathTree(const std::vector<Vertex<T>> & vertices);
+
+   /// Number of vertices in the tree, reached or not.
+   int size() const;
+   /// Number of vertices reached from the start vertex, including the start.
+   int reachedCount() const;
+   /// Index of the vertex, -1 if the vertex is not in the tree.
+   int indexOf(const Vertex<T> & vertex) const;
+   /// The vertex with the index.
+   const Vertex<T> & vertexAt(int index) const;
+   /// Index of the start vertex, -1 if the tree is empty.
+   int startIndex() const;
+
+   /// Is there a path from the start to the vertex.
+   bool reaches(const Vertex<T> & vertex) const;
+   bool reaches(int index) const;
+   /// Distance from the start to the vertex, infinity if the vertex cannot be reached.
+   double distanceTo(const Vertex<T> & vertex) const;
+   double distanceTo(int index) const;
+   /// Index of the vertex before this one on the path from start, -1 for start and vertices not reached.
+   int parentOf(int index) const;
+   /// Weight of the edge from the parent to the vertex.
+   double weightTo(int index) const;
+
+   /// Fills the buffer with the vertex indices on the path from the start to the destination,
+   /// start first. Buffer is empty if destination cannot be reached. Returns the number of
+   /// edges on the route. Reusing the same buffer between calls avoids allocations.
+   int routeTo(const Vertex<T> & destination, std::vector<int> & buffer) const;
+   int routeTo(int destination, std::vector<int> & buffer) const;
+   /// Number of edges on the path from the start to the vertex, -1 if vertex cannot be reached.
+   int hopsTo(int index) const;
+
+   /// Reached vertex indices in the order the search settled them.
+   const_iterator begin() const;
+   const_iterator end() const;
+
+   /// Used by the search to set the start vertex.
+   void setStart(int index);
+   /// Used by the search to update the path to a vertex.
+   void setParent(int index, int parent, double weight, double distance);
+   /// Used by the search to tell that the path to the vertex is final.
+   void settle(int index);
+
+private:
+   std::vector<Vertex<T>> vertices;    // Vertices in the order of their index.
+   std::vector<int> parents;           // Index of the previous vertex on the path.
+   std::vector<double> weights;        // Weight of the edge from the parent.
+   std::vector<double> distances;      // Distance from the start.
+   std::vector<int> settled;           // Reached vertices in the order they were settled.
+   int start;
+};
+
+
+template <typename T>
+ShortestPathTree<T>::ShortestPathTree()
+: start(-1) {
+}
+
+template <typename T>
+ShortestPathTree<T>::ShortestPathTree(const std::vector<Vertex<T>> & vertices)
+: vertices(vertices),
+  parents(vertices.size(), -1),
+  weights(vertices.size(), 0.0),
+  distances(vertices.size(), std::numeric_limits<double>::infinity()),
+  start(-1) {
+   settled.reserve(vertices.size());
+}
+
+template <typename T>
+int ShortestPathTree<T>::size() const {
+   return static_cast<int>(vertices.size());
+}
+
+template <typename T>
+int ShortestPathTree<T>::reachedCount() const {
+   return static_cast<int>(settled.size());
+}
+
+/*
+ Vertices are sorted, so binary search finds the index.
+ */
+template <typename T>
+int ShortestPathTree<T>::indexOf(const Vertex<T> & vertex) const {
+   auto found = std::lower_bound(vertices.begin(), vertices.end(), vertex);
+   if (found == vertices.end() || !(*found == vertex)) {
+      return -1;
+   }
+   return static_cast<int>(found - vertices.begin());
+}
+
+template <typename T>
+const Vertex<T> & ShortestPathTree<T>::vertexAt(int index) const {
+   return vertices.at(index);
+}
+
+template <typename T>
+int ShortestPathTree<T>::startIndex() const {
+   return start;
+}
+
+template <typename T>
+bool ShortestPathTree<T>::reaches(const Vertex<T> & vertex) const {
+   int index = indexOf(vertex);
+   return index >= 0 && reaches(index);
+}
+
+template <typename T>
+bool ShortestPathTree<T>::reaches(int index) const {
+   return index == start || parents[index] >= 0;
+}
+
+template <typename T>
+double ShortestPathTree<T>::distanceTo(const Vertex<T> & vertex) const {
+   int index = indexOf(vertex);
+   if (index < 0) {
+      return std::numeric_limits<double>::infinity();
+   }
+   return distances[index];
+}
+
+template <typename T>
+double ShortestPathTree<T>::distanceTo(int index) const {
+   return distances[index];
+}
+
+template <typename T>
+int ShortestPathTree<T>::parentOf(int index) const {
+   return parents[index];
+}
+
+template <typename T>
+double ShortestPathTree<T>::weightTo(int index) const {
+   return weights[index];
+}
+
+template <typename T>
+int ShortestPathTree<T>::routeTo(const Vertex<T> & destination, std::vector<int> & buffer) const {
+   int index = indexOf(destination);
+   if (index < 0) {
+      buffer.clear();
+      return 0;
+   }
+   return routeTo(index, buffer);
+}
+
+/*
+ Walks the parents from the destination back to the start, and then reverses
+ the buffer so that the start is first.
+ */
+template <typename T>
+int ShortestPathTree<T>::routeTo(int destination, std::vector<int> & buffer) const {
+   buffer.clear();
+   if (destination < 0 || !reaches(destination)) {
+      return 0;
+   }
+   for (int index = destination; index >= 0; index = parents[index]) {
+      buffer.push_back(index);
+   }
+   std::reverse(buffer.begin(), buffer.end());
+   return static_cast<int>(buffer.size()) - 1;
+}
+
+template <typename T>
+int ShortestPathTree<T>::hopsTo(int index) const {
+   if (!reaches(index)) {
+      return -1;
+   }
+   int hops = 0;
+   for (int parent = parents[index]; parent >= 0; parent = parents[parent]) {
+      hops++;
+   }
+   return hops;
+}
+
+template <typename T>
+typename ShortestPathTree<T>::const_iterator ShortestPathTree<T>::begin() const {
+   return settled.begin();
+}
+
+template <typename T>
+typename ShortestPathTree<T>::const_iterator ShortestPathTree<T>::end() const {
+   return settled.end();
+}
+
+template <typename T>
+void ShortestPathTree<T>::setStart(int index) {
+   start = index;
+   parents[index] = -1;
+   weights[index] = 0.0;
+   distances[index] = 0.0;
+}
+
+template <typename T>
+void ShortestPathTree<T>::setParent(int index, int parent, double weight, double distance) {
+   parents[index] = parent;
+   weights[index] = weight;
+   distances[index] = distance;
+}
+
+template <typename T>
+void ShortestPathTree<T>::settle(int index) {
+   settled.push_back(index);
+}
+
+#endif /* ShortestPathTree_hpp */
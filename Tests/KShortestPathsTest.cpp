@@ -0,0 +1,96 @@
+//
+//  KShortestPathsTest.cpp
+//  Tests
+//
+//  Checks the paths of KShortestPaths against all the simple paths between the two
+//  vertices, enumerated by brute force, on small random directed and undirected graphs.
+//
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+
+#include "Graph.hpp"
+#include "KShortestPaths.hpp"
+#include "GraphGenerator.hpp"
+
+// Lengths of all the simple paths from source to target, shortest first.
+std::vector<double> allPathLengths(const Graph<int> & graph, int source, int target) {
+   std::vector<double> lengths;
+   std::set<int> visited;
+   std::function<void(int, double)> extend = [&](int vertex, double length) {
+      if (vertex == target) {
+         lengths.push_back(length);
+         return;
+      }
+      visited.insert(vertex);
+      for (const auto & edge : graph.edges(Vertex<int>(vertex))) {
+         if (visited.count(edge.destination.data) == 0) {
+            extend(edge.destination.data, length + edge.weight);
+         }
+      }
+      visited.erase(vertex);
+   };
+   extend(source, 0.0);
+   std::sort(lengths.begin(), lengths.end());
+   return lengths;
+}
+
+// Tells why the paths are not the k shortest simple paths, empty if they are.
+std::string checkPaths(const std::vector<RankedPath<int>> & paths, const std::vector<double> & lengths, int source, int target, int k) {
+   if (paths.size() != std::min<std::size_t>(k, lengths.size())) {
+      return "found " + std::to_string(paths.size()) + " paths of " + std::to_string(lengths.size());
+   }
+   for (std::size_t index = 0; index < paths.size(); index++) {
+      std::set<int> seen = {source};
+      int at = source;
+      double sum = 0.0;
+      for (const auto & edge : paths[index].edges) {
+         if (edge.source.data != at) {
+            return "path " + std::to_string(index) + " is not connected";
+         }
+         at = edge.destination.data;
+         if (!seen.insert(at).second) {
+            return "path " + std::to_string(index) + " has a loop";
+         }
+         sum += edge.weight;
+      }
+      if (at != target) {
+         return "path " + std::to_string(index) + " does not end at the target";
+      }
+      if (std::abs(sum - paths[index].length) > 1e-9 || std::abs(lengths[index] - paths[index].length) > 1e-9) {
+         return "path " + std::to_string(index) + " has length " + std::to_string(paths[index].length) +
+                ", expected " + std::to_string(lengths[index]);
+      }
+   }
+   return "";
+}
+
+int main() {
+   int failures = 0;
+   int checked = 0;
+   for (int seed = 1; seed <= 300; seed++) {
+      GraphGenerator generator(seed, 10, EUniformWeights);
+      const int vertexCount = 8 + seed % 5;
+      auto edges = generator.randomSparse(vertexCount, vertexCount * 2 + seed % 7);
+      Graph<int> graph;
+      GraphGenerator::fill(graph, vertexCount, edges, seed % 2 ? EDirected : EUndirected);
+      const std::vector<double> lengths = allPathLengths(graph, 1, vertexCount);
+      KShortestPaths<int> shortestPaths(graph);
+      for (int k : {1, 3, 7, 20}) {
+         auto paths = shortestPaths.kShortestPaths(Vertex<int>(1), Vertex<int>(vertexCount), k);
+         std::string problem = checkPaths(paths, lengths, 1, vertexCount, k);
+         checked++;
+         if (!problem.empty()) {
+            failures++;
+            std::cerr << "Seed " << seed << ", k " << k << ": " << problem << std::endl;
+         }
+      }
+   }
+   std::cout << checked - failures << " of " << checked << " checks passed" << std::endl;
+   return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,189 @@
+#ifndef TimeWindowDijkstra_hpp
+#define TimeWindowDijkstra_hpp
+
+#include <queue>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "Graph.hpp"
+#include "ShortestPathTree.hpp"
+#include "AlgorithmStats.hpp"
+#include "Trace.hpp"
+
+/// What to do when arriving to a station that is closed.
+enum ClosedStationPolicy {
+   EWaitUntilOpen,   // Wait at the station until it opens.
+   ESkipClosed       // Do not use the station at that time.
+};
+
+/**
+ Dijkstra's algorithm finding the earliest arrival times from a start station leaving at
+ a given time, when the stations can be used only while they are open.
+
+ The data of the vertices must have the members opens and closes, the opening hours as
+ hours of the day (0...24), like the Station of the TrainTravelling example. If opens is
+ after closes, the station is open over midnight. If opens equals closes, the opening hours
+ are not known and the station is always open. Edge weights multiplied by hoursPerWeight
+ give the travel time in hours, so for example with distances in km and trains running
+ 100 km/h, hoursPerWeight is 0.01.
+
+ Times are hours from the midnight of the departure day, so a trip may go on to the next days.
+ The opening hours are checked during the search, so no filtered copy of the graph is needed
+ for each departure time, and a search costs about the same as a plain Dijkstra search.
+
+ With EWaitUntilOpen, arriving later never makes it possible to continue earlier, so the
+ search gives the earliest possible arrivals. With ESkipClosed, waiting is not allowed and
+ each station is used at the earliest time it is open on arrival; a route needing to arrive
+ later to a station to find the next one open is not found.
+ */
+template <typename T>
+class TimeWindowDijkstra {
+public:
+   TimeWindowDijkstra(const Graph<T> & graph, double hoursPerWeight = 1.0, ClosedStationPolicy policy = EWaitUntilOpen);
+
+   // Gives the tree of earliest arrivals from start when leaving at departure (hours).
+   // distanceTo() of the tree is the time the station can be left for the next one, which
+   // includes waiting for the station to open. weightTo() is the weight of the edge used to get there.
+   // With ESkipClosed, nothing is reached if the start is closed at departure.
+   std::shared_ptr<const ShortestPathTree<T>> earliestArrivalsFrom(const Vertex<T> & start, double departure) const;
+   // Like above, also counting the work done to stats when compiled with GRAPH_STATS.
+   std::shared_ptr<const ShortestPathTree<T>> earliestArrivalsFrom(const Vertex<T> & start, double departure, AlgorithmStats & stats) const;
+
+   // Is the station open at the time (hours, may be more than 24).
+   static bool isOpen(const T & station, double time);
+   // The first time from time on the station is open.
+   static double nextOpening(const T & station, double time);
+
+   // The graph to use to find the routes.
+   const Graph<T> & graph;
+
+private:
+   // Time at a vertex and the index of the vertex.
+   typedef std::pair<double, int> QueueElement;
+   typedef std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> SearchQueue;
+
+   // The time the station can be left when arriving at the time, infinity if it cannot be used.
+   double readyTime(const T & station, double arrival) const;
+   // Does the work of the public functions.
+   std::shared_ptr<const ShortestPathTree<T>> search(const Vertex<T> & start, double departure, AlgorithmStats * stats) const;
+
+   double hoursPerWeight;
+   ClosedStationPolicy policy;
+};
+
+
+template <typename T>
+TimeWindowDijkstra<T>::TimeWindowDijkstra(const Graph<T> & graph, double hoursPerWeight, ClosedStationPolicy policy)
+: graph(graph), hoursPerWeight(hoursPerWeight), policy(policy) {
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> TimeWindowDijkstra<T>::earliestArrivalsFrom(const Vertex<T> & start, double departure) const {
+   return search(start, departure, nullptr);
+}
+
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> TimeWindowDijkstra<T>::earliestArrivalsFrom(const Vertex<T> & start, double departure, AlgorithmStats & stats) const {
+   return search(start, departure, &stats);
+}
+
+template <typename T>
+bool TimeWindowDijkstra<T>::isOpen(const T & station, double time) {
+   if (station.opens == station.closes) {
+      return true;
+   }
+   double hour = time - 24.0 * std::floor(time / 24.0);
+   if (station.opens < station.closes) {
+      return hour >= station.opens && hour < station.closes;
+   }
+   return hour >= station.opens || hour < station.closes;
+}
+
+template <typename T>
+double TimeWindowDijkstra<T>::nextOpening(const T & station, double time) {
+   if (isOpen(station, time)) {
+      return time;
+   }
+   // Closed, so the station opens next at the opening hour of today or tomorrow.
+   double opening = 24.0 * std::floor(time / 24.0) + station.opens;
+   return opening < time ? opening + 24.0 : opening;
+}
+
+template <typename T>
+double TimeWindowDijkstra<T>::readyTime(const T & station, double arrival) const {
+   if (policy == EWaitUntilOpen) {
+      return nextOpening(station, arrival);
+   }
+   return isOpen(station, arrival) ? arrival : std::numeric_limits<double>::infinity();
+}
+
+/*
+ Same as Dijkstra::searchFrom with the shortest paths, except that the distance of a vertex
+ is the time it can be left, and a vertex is not reached at a time it cannot be used.
+ Opening hours are taken from the vertices of the graph's adjacencies, not from the edges.
+ */
+template <typename T>
+std::shared_ptr<const ShortestPathTree<T>> TimeWindowDijkstra<T>::search(const Vertex<T> & start, double departure, AlgorithmStats * stats) const {
+   GRAPH_TRACE_SPAN("TimeWindowDijkstra::earliestArrivalsFrom");
+   StatsTimer timer(stats);
+   std::vector<Vertex<T>> vertices;
+   std::vector<const std::vector<Edge<T>> *> edgeLists;
+   vertices.reserve(graph.adjacencies.size());
+   edgeLists.reserve(graph.adjacencies.size());
+   for (const auto & vertexAndEdges : graph.adjacencies) {
+      vertices.push_back(vertexAndEdges.first);
+      edgeLists.push_back(&vertexAndEdges.second);
+   }
+   auto tree = std::make_shared<ShortestPathTree<T>>(vertices);
+   int startIndex = tree->indexOf(start);
+   GRAPH_STATS_ADD(stats, lookups, 1);
+   if (startIndex < 0) {
+      return tree;
+   }
+   double leaving = readyTime(tree->vertexAt(startIndex).data, departure);
+   if (leaving == std::numeric_limits<double>::infinity()) {
+      return tree;   // Start is closed and waiting is not allowed.
+   }
+   std::vector<bool> settled(vertices.size(), false);
+   SearchQueue priorityQueue;
+   tree->setStart(startIndex);
+   tree->setParent(startIndex, -1, 0.0, leaving);
+   priorityQueue.push(QueueElement(leaving, startIndex));
+   GRAPH_STATS_ADD(stats, heapPushes, 1);
+   GrowthCounter queueGrowth(stats);
+   queueGrowth.sizeIs(priorityQueue.size());
+
+   while (!priorityQueue.empty()) {
+      auto [time, index] = priorityQueue.top();
+      priorityQueue.pop();
+      GRAPH_STATS_ADD(stats, heapPops, 1);
+      if (settled[index]) {
+         GRAPH_STATS_ADD(stats, stalePops, 1);
+         continue;
+      }
+      settled[index] = true;
+      tree->settle(index);
+      GRAPH_STATS_ADD(stats, verticesSettled, 1);
+      for (const auto & edge : *edgeLists[index]) {
+         int destination = tree->indexOf(edge.destination);
+         GRAPH_STATS_ADD(stats, edgesRelaxed, 1);
+         GRAPH_STATS_ADD(stats, lookups, 1);
+         if (destination < 0 || settled[destination]) {
+            continue;
+         }
+         double candidate = readyTime(tree->vertexAt(destination).data, time + edge.weight * hoursPerWeight);
+         if (candidate < tree->distanceTo(destination)) {
+            tree->setParent(destination, index, edge.weight, candidate);
+            GRAPH_STATS_ADD(stats, edgesImproved, 1);
+            priorityQueue.push(QueueElement(candidate, destination));
+            GRAPH_STATS_ADD(stats, heapPushes, 1);
+            queueGrowth.sizeIs(priorityQueue.size());
+         }
+      }
+   }
+   return tree;
+}
+
+#endif /* TimeWindowDijkstra_hpp */
@@ -0,0 +1,181 @@
+#ifndef Trace_hpp
+#define Trace_hpp
+
+#include <algorithm>
+#include <atomic>    // enabled flag checked by every span
+#include <chrono>
+#include <cstdlib>   // atexit
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// A finished span: a named piece of work on a thread, with start time and duration.
+struct TraceEvent {
+   const char * name;            // Must be a string literal or otherwise live until the trace is written.
+   long long startNanoseconds;   // From the time tracing started.
+   long long durationNanoseconds;
+};
+
+/// Collects trace spans and writes them as a Chrome trace-event JSON file, which can be
+/// viewed in chrome://tracing or https://ui.perfetto.dev.
+///
+/// Each thread records its spans to its own buffer, so recording needs no locking.
+/// Buffers are written to the file at exit, or when write() is called. Threads recording
+/// spans must have finished by then. Each thread keeps at most maxEventsPerThread spans;
+/// later spans are dropped and counted, so tracing a huge graph load does not use all memory.
+///
+/// Spans are placed in code with GRAPH_TRACE_SPAN("name"). The macro is empty unless
+/// GRAPH_TRACE is defined, and when compiled in, a span only checks a flag until start() is called.
+class Tracer {
+public:
+   /// Starts recording spans, writing them to the file at exit.
+   static void start(const std::string & filePath, std::size_t maxEventsPerThread = 1000000);
+   /// Is recording on.
+   static bool isEnabled();
+   /// Writes the recorded spans to the file given to start(). Returns false if writing failed.
+   static bool write();
+   /// Nanoseconds since tracing started.
+   static long long now();
+   /// Records a finished span of the calling thread.
+   static void record(const char * name, long long startNanoseconds, long long durationNanoseconds);
+
+private:
+   /// Spans of one thread.
+   struct ThreadBuffer {
+      int threadId;
+      long dropped = 0;
+      std::vector<TraceEvent> events;
+   };
+
+   static ThreadBuffer & threadBuffer();
+   static void writeAtExit();
+
+   static inline std::atomic<bool> enabled{false};
+   static inline std::mutex mutex;                                   // Guards the buffer list and the settings.
+   static inline std::vector<std::shared_ptr<ThreadBuffer>> buffers; // All the thread buffers, also of finished threads.
+   static inline std::string path;
+   static inline std::size_t maxEvents = 1000000;
+   static inline bool atExitRegistered = false;
+   static inline std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+/// Measures the time from creation to destruction as a span, if tracing is on.
+class TraceSpan {
+public:
+   TraceSpan(const char * name)
+   : name(name), started(Tracer::isEnabled() ? Tracer::now() : -1) {
+   }
+   ~TraceSpan() {
+      if (started >= 0) {
+         Tracer::record(name, started, Tracer::now() - started);
+      }
+   }
+   TraceSpan(const TraceSpan &) = delete;
+   const TraceSpan & operator = (const TraceSpan &) = delete;
+
+private:
+   const char * name;
+   long long started;
+};
+
+#ifdef GRAPH_TRACE
+#define GRAPH_TRACE_CONCAT2(a, b) a##b
+#define GRAPH_TRACE_CONCAT(a, b) GRAPH_TRACE_CONCAT2(a, b)
+/// Traces the rest of the enclosing scope as a span with the name.
+#define GRAPH_TRACE_SPAN(name) TraceSpan GRAPH_TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define GRAPH_TRACE_SPAN(name) do { } while (false)
+#endif
+
+
+inline void Tracer::start(const std::string & filePath, std::size_t maxEventsPerThread) {
+   std::lock_guard<std::mutex> guard(mutex);
+   path = filePath;
+   maxEvents = maxEventsPerThread;
+   if (!atExitRegistered) {
+      std::atexit(writeAtExit);
+      atExitRegistered = true;
+   }
+   epoch = std::chrono::steady_clock::now();
+   enabled = true;
+}
+
+inline bool Tracer::isEnabled() {
+   return enabled.load(std::memory_order_relaxed);
+}
+
+inline long long Tracer::now() {
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+/*
+ Each thread creates its buffer on the first span and registers it to the list of buffers.
+ The list keeps the buffer alive after the thread has finished.
+ */
+inline Tracer::ThreadBuffer & Tracer::threadBuffer() {
+   thread_local std::shared_ptr<ThreadBuffer> buffer;
+   if (!buffer) {
+      buffer = std::make_shared<ThreadBuffer>();
+      std::lock_guard<std::mutex> guard(mutex);
+      buffer->threadId = static_cast<int>(buffers.size()) + 1;
+      buffer->events.reserve(std::min<std::size_t>(maxEvents, 4096));
+      buffers.push_back(buffer);
+   }
+   return *buffer;
+}
+
+inline void Tracer::record(const char * name, long long startNanoseconds, long long durationNanoseconds) {
+   ThreadBuffer & buffer = threadBuffer();
+   if (buffer.events.size() >= maxEvents) {
+      buffer.dropped++;
+      return;
+   }
+   buffer.events.push_back({name, startNanoseconds, durationNanoseconds});
+}
+
+/*
+ Writes the complete ("X") events with microsecond timestamps, as Chrome expects.
+ Dropped span counts are written as metadata of each thread.
+ */
+inline bool Tracer::write() {
+   std::lock_guard<std::mutex> guard(mutex);
+   if (path.empty()) {
+      return false;
+   }
+   std::ofstream file(path);
+   if (!file) {
+      return false;
+   }
+   // Fixed notation, so long traces do not get timestamps in exponent form.
+   file << std::fixed << std::setprecision(3);
+   file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+   bool first = true;
+   for (const auto & buffer : buffers) {
+      for (const auto & event : buffer->events) {
+         file << (first ? "" : ",\n")
+              << "{\"name\": \"" << event.name << "\", \"cat\": \"graph\", \"ph\": \"X\", \"pid\": 1"
+              << ", \"tid\": " << buffer->threadId
+              << ", \"ts\": " << event.startNanoseconds / 1000.0
+              << ", \"dur\": " << event.durationNanoseconds / 1000.0 << "}";
+         first = false;
+      }
+      file << (first ? "" : ",\n")
+           << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->threadId
+           << ", \"args\": {\"name\": \"thread " << buffer->threadId << "\", \"dropped_spans\": " << buffer->dropped << "}}";
+      first = false;
+   }
+   file << "\n]}\n";
+   return static_cast<bool>(file);
+}
+
+inline void Tracer::writeAtExit() {
+   if (isEnabled()) {
+      enabled = false;
+      write();
+   }
+}
+
+#endif /* Trace_hpp */
@@ -8,17 +8,23 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <numeric>
 
 #include "Graph.hpp"
 #include "Dijkstra.hpp"
 #include "Station.hpp"
 #include "Prim.hpp"
+#include "TimeWindowDijkstra.hpp"
+#include "Betweenness.hpp"
 
 // Helper funcs
 void createNetwork(Graph<Station> & network);
 void printVertices(const std::vector<Vertex<Station>> & vertices);
 void printPath(const std::vector<Edge<Station>> & path);
-void printPaths(const std::map<Vertex<Station>, Visit<Station>> & paths);
+void printPaths(const ShortestPathTree<Station> & paths);
+void printTimedPath(const ShortestPathTree<Station> & arrivals, const Station & destination, double hoursPerWeight);
 
 int main(int argc, const char * argv[]) {
 
@@ -70,15 +76,23 @@ int main(int argc, const char * argv[]) {
    std::cout << " --- Using Dijkstra's algorithm to find shortest path from Oulu to Vainikkala" << std::endl << std::endl;
    Dijkstra<Station> dijkstra(network);
    std::cout << "First get all shortest paths from Oulu" << std::endl;
-   auto pathsFromOulu = dijkstra.shortestPathsFrom(oulu);
-   printPaths(pathsFromOulu);
-   auto path = dijkstra.shortestPathTo(vainikkala, pathsFromOulu);
+   auto pathsFromOulu = dijkstra.shortestPathTreeFrom(oulu);
+   printPaths(*pathsFromOulu);
+   auto path = dijkstra.shortestPathTo(vainikkala, *pathsFromOulu);
    printPath(path);
 
    std::cout << " --- Using Dijkstra's algorithm to find shortest path from Oulu to Turku:" << std::endl << std::endl;
-   path = dijkstra.shortestPathTo(turku, pathsFromOulu);
+   path = dijkstra.shortestPathTo(turku, *pathsFromOulu);
    printPath(path);
 
+   std::cout << " --- Line from Tampere to Turku closed for maintenance, shortest path from Oulu to Turku:" << std::endl << std::endl;
+   double tampereTurku = network.weight(tampere, turku);
+   network.removeEdge(EdgeType::EUndirected, tampere, turku);
+   path = dijkstra.shortestPathTo(turku, *dijkstra.shortestPathTreeFrom(oulu));
+   printPath(path);
+   // Line is open again.
+   network.addUndirectedEdge(tampere, turku, tampereTurku);
+
    std::cout << " --- Using the Prim algorithm to find the minimum spanning tree of the train network." << std::endl << std::endl;
    std::pair<double,Graph<Station>> result = Prim<Station>().produceMinimumSpanningTreeFor(network);
    std::cout << "Minimum trip in smallest network to travel is " << result.first << " km." << std::endl;
@@ -92,6 +106,27 @@ int main(int argc, const char * argv[]) {
       std::cout << "--- Topological sort result for Finnish train network:" << std::endl;
       printVertices(topoList);
    }
+
+   // Trains run 100 km/h, so a kilometre takes 0.01 hours.
+   std::cout << std::endl << " --- Leaving Oulu at 5:00 to Turku, waiting at stations until they open:" << std::endl << std::endl;
+   TimeWindowDijkstra<Station> waiting(network, 0.01, EWaitUntilOpen);
+   printTimedPath(*waiting.earliestArrivalsFrom(oulu, 5.0), turku, 0.01);
+   std::cout << " --- Leaving Oulu at 11:00 to Turku, using only stations open at arrival:" << std::endl << std::endl;
+   TimeWindowDijkstra<Station> skipping(network, 0.01, ESkipClosed);
+   printTimedPath(*skipping.earliestArrivalsFrom(oulu, 11.0), turku, 0.01);
+
+   std::cout << std::endl << " --- Stations most travelled through on the shortest routes (betweenness):" << std::endl << std::endl;
+   Betweenness<Station> betweenness(network, EdgeType::EUndirected);
+   std::vector<double> centrality = betweenness.exact();
+   std::vector<int> stations(centrality.size());
+   std::iota(stations.begin(), stations.end(), 0);
+   std::stable_sort(stations.begin(), stations.end(), [&centrality](int first, int second) {
+      return centrality[first] > centrality[second];
+   });
+   for (std::size_t rank = 0; rank < std::min<std::size_t>(5, stations.size()); rank++) {
+      std::cout << std::setw(12) << betweenness.vertices()[stations[rank]] << " " << centrality[stations[rank]] << " routes" << std::endl;
+   }
+
    std::cout << std::endl << "<<<< Thank you for travelling in Finland! <<<<" << std::endl << std::endl;
    return EXIT_SUCCESS;
 }
@@ -166,48 +201,66 @@ void printPath(const std::vector<Edge<Station>> & path) {
 
 // Helper function to show the visits done by Dijkstra in the first step
 // when finding the shortest paths from starting station.
-void printPaths(const std::map<Vertex<Station>, Visit<Station>> & paths) {
-   // Visits arranged by Station operator < so based on station name.
-   // We wish to print starting visit first, then other so let's do that.
-   // Using tempPath since it is easier to erase paths as we print them and
-   // concentrate on those paths not yet printed.
-   auto tempPath = paths;
-
-   // Printing out paths in some sensible order until all are handled and tempPath is empty.
-   Vertex<Station> station;
-   std::queue<Vertex<Station>> nextStations;
-   while (!tempPath.empty()) {
-      bool startFound = false;
-      auto iterator = tempPath.begin();
-      // First print the starting edge, and remove it from map when done.
-      while (!startFound && iterator != tempPath.end()) {
-         if (iterator->second.type == VisitType::EStart) {
-            station = iterator->first;
-            std::cout << "Starting from: " << station << std::endl;
-            tempPath.erase(iterator);
-            nextStations.push(station);
-            startFound = true;
-            break; // (iterator != paths.end())
-         }
-         iterator++;
+void printPaths(const ShortestPathTree<Station> & paths) {
+   // Print the starting station first, then the edges station by station in breadth first order.
+   // Tree only knows the parent of each station, so first link the children of each station
+   // into lists, in the order of the station index (name), to find the edges from a station.
+   std::vector<int> firstChild(paths.size(), -1);
+   std::vector<int> nextSibling(paths.size(), -1);
+   for (int index = paths.size() - 1; index >= 0; index--) {
+      int parent = paths.parentOf(index);
+      if (parent >= 0) {
+         nextSibling[index] = firstChild[parent];
+         firstChild[parent] = index;
+      }
+   }
+   if (paths.startIndex() < 0) {
+      std::cout << std::endl;
+      return;
+   }
+   std::cout << "Starting from: " << paths.vertexAt(paths.startIndex()) << std::endl;
+   std::queue<int> nextStations;
+   nextStations.push(paths.startIndex());
+   while (!nextStations.empty()) {
+      int station = nextStations.front();
+      nextStations.pop();
+      for (int child = firstChild[station]; child >= 0; child = nextSibling[child]) {
+         std::cout << " Edge " << paths.vertexAt(station) << "-> " << paths.vertexAt(child);
+         std::cout << " " << paths.weightTo(child) << " km." << std::endl;
+         nextStations.push(child);
       }
-      // Then print edges in order and remove them when done. Only Edges here so no need to check visit type.
-      while (!nextStations.empty()) {
-         station = nextStations.front();
-         nextStations.pop();
-         iterator = tempPath.begin();
-         while (iterator != tempPath.end()) {
-            if (iterator->second.edge.source == station) {
-               std::cout << " Edge " << iterator->second.edge.source << "-> " << iterator->second.edge.destination;
-               std::cout << " " << iterator->second.edge.weight << " km." << std::endl;
-               nextStations.push(iterator->second.edge.destination);
-               tempPath.erase(iterator);
-               iterator = tempPath.begin();
-            } else {
-               iterator++;
-            }
-         }
+   }
+   std::cout << std::endl;
+}
+
+// Prints the time as hours and minutes, with the day if not the first one.
+std::string clockTime(double hours) {
+   int minutes = static_cast<int>(std::lround(hours * 60.0));
+   std::ostringstream time;
+   time << std::setw(2) << std::setfill('0') << (minutes / 60) % 24 << ":" << std::setw(2) << minutes % 60;
+   if (minutes >= 24 * 60) {
+      time << " (+" << minutes / (24 * 60) << ")";
+   }
+   return time.str();
+}
+
+// Prints the route with the arrival and leaving times at each station.
+void printTimedPath(const ShortestPathTree<Station> & arrivals, const Station & destination, double hoursPerWeight) {
+   std::vector<int> route;
+   arrivals.routeTo(destination, route);
+   if (route.empty()) {
+      std::cout << "No route to " << destination << " at the time." << std::endl << std::endl;
+      return;
+   }
+   std::cout << std::setw(12) << arrivals.vertexAt(route[0]) << " leave " << clockTime(arrivals.distanceTo(route[0])) << std::endl;
+   for (std::size_t step = 1; step < route.size(); step++) {
+      double leaving = arrivals.distanceTo(route[step]);
+      double arriving = arrivals.distanceTo(route[step - 1]) + arrivals.weightTo(route[step]) * hoursPerWeight;
+      std::cout << std::setw(12) << arrivals.vertexAt(route[step]) << " arrive " << clockTime(arriving);
+      if (leaving > arriving) {
+         std::cout << ", opens " << clockTime(leaving);
       }
+      std::cout << std::endl;
    }
    std::cout << std::endl;
 }
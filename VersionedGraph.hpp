@@ -0,0 +1,103 @@
+#ifndef VersionedGraph_hpp
+#define VersionedGraph_hpp
+
+#include <memory>       // snapshots are shared by the readers
+#include <mutex>        // one writer at a time
+#include <atomic>       // counting the published versions
+#include <functional>   // changes given as a function
+#include <utility>      // std::move
+
+#include "Graph.hpp"
+
+/// A graph that can be read from several threads while it is being changed.
+///
+/// Readers take a snapshot, an immutable version of the graph that stays the same as long
+/// as the reader keeps it, and use it with the algorithms, e.g. Dijkstra<T>(*snapshot).
+/// A writer changes a copy of the latest version and publishes it atomically. Readers
+/// taking a snapshot after that get the new version, while the ones still using an older
+/// version are not disturbed. A version is freed when the last snapshot of it is released.
+///
+/// Taking a snapshot never waits for the writers, so queries are answered at the same speed
+/// while the graph is changed. A change copies the whole graph, so changes should be given
+/// in batches: one update() applying many changes copies the graph only once.
+template <typename T>
+class VersionedGraph {
+public:
+   /// An immutable version of the graph.
+   typedef std::shared_ptr<const Graph<T>> Snapshot;
+
+   /// Creates an empty graph.
+   VersionedGraph();
+   /// Makes the graph the first version.
+   explicit VersionedGraph(Graph<T> graph);
+   VersionedGraph(const VersionedGraph<T> &) = delete;
+   const VersionedGraph<T> & operator = (const VersionedGraph<T> &) = delete;
+
+   /// Gets the latest version of the graph.
+   Snapshot snapshot() const;
+   /// Applies the changes to a copy of the latest version and publishes the copy.
+   /// Writers are serialized, so no changes are lost. Returns the number of the new version.
+   unsigned long update(const std::function<void(Graph<T> &)> & changes);
+   /// Publishes the graph as the latest version. Returns the number of the new version.
+   unsigned long publish(Graph<T> graph);
+   /// Gets the number of the latest version, starting from zero and incremented by each publication.
+   unsigned long versionNumber() const;
+
+private:
+   /// Makes the graph the latest version. Caller holds the writer mutex.
+   unsigned long publishLocked(Snapshot graph);
+
+   Snapshot latest;
+   std::atomic<unsigned long> published;
+   std::mutex writerMutex;
+};
+
+
+template <typename T>
+VersionedGraph<T>::VersionedGraph()
+: latest(std::make_shared<const Graph<T>>()), published(0) {
+}
+
+template <typename T>
+VersionedGraph<T>::VersionedGraph(Graph<T> graph)
+: latest(std::make_shared<const Graph<T>>(std::move(graph))), published(0) {
+}
+
+/*
+ The shared pointer is read atomically, so a reader gets either the old or the new
+ version while a writer is publishing, and holding it keeps that version alive.
+ */
+template <typename T>
+typename VersionedGraph<T>::Snapshot VersionedGraph<T>::snapshot() const {
+   return std::atomic_load(&latest);
+}
+
+/*
+ The copy is changed while the readers go on with the latest version.
+ */
+template <typename T>
+unsigned long VersionedGraph<T>::update(const std::function<void(Graph<T> &)> & changes) {
+   std::lock_guard<std::mutex> guard(writerMutex);
+   auto copy = std::make_shared<Graph<T>>(*std::atomic_load(&latest));
+   changes(*copy);
+   return publishLocked(copy);
+}
+
+template <typename T>
+unsigned long VersionedGraph<T>::publish(Graph<T> graph) {
+   std::lock_guard<std::mutex> guard(writerMutex);
+   return publishLocked(std::make_shared<const Graph<T>>(std::move(graph)));
+}
+
+template <typename T>
+unsigned long VersionedGraph<T>::versionNumber() const {
+   return published;
+}
+
+template <typename T>
+unsigned long VersionedGraph<T>::publishLocked(Snapshot graph) {
+   std::atomic_store(&latest, graph);
+   return ++published;
+}
+
+#endif /* VersionedGraph_hpp */
@@ -0,0 +1,21 @@
+#ifndef Visit_hpp
+#define Visit_hpp
+
+#include "Edge.hpp"
+
+// Visiting paths are either of type Start (visiting starts) or
+// after starting from the first node, travelling between edges.
+enum VisitType {
+   EStart,
+   EEdge
+};
+
+// A visit has a type and when visiting between vertices (after the starting node)
+// also an edge.
+template <typename T>
+struct Visit {
+   VisitType type;
+   Edge<T> edge;
+};
+
+#endif /* Visit_hpp */